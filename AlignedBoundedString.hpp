@@ -0,0 +1,206 @@
+#ifndef ALIGNED_BOUNDED_STRING_HPP
+#define ALIGNED_BOUNDED_STRING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "InlineBoundedString.hpp"
+
+namespace bounded_string_detail
+{
+
+/// Which elements of one %per_thread_array are held by a live thread.
+/**
+ * Shared between the array and the threads holding its elements, so a
+ * thread which outlives the array can still release its claim.
+ */
+struct thread_slot_claims
+{
+  explicit
+  thread_slot_claims(std::size_t count)
+  : claimed(std::make_unique<std::atomic<bool>[]>(count)),
+    size(count)
+  {}
+
+  std::unique_ptr<std::atomic<bool>[]> claimed;
+  std::size_t size;
+};
+
+/// The elements the calling thread has claimed, released when the thread exits.
+class thread_slot_registry
+{
+public:
+  thread_slot_registry() = default;
+  thread_slot_registry(const thread_slot_registry &) = delete;
+  thread_slot_registry & operator=(const thread_slot_registry &) = delete;
+
+  ~thread_slot_registry() noexcept
+  {
+    for (const auto & entry : entries_) {
+      entry.claims->claimed[entry.index].store(false, std::memory_order_release);
+    }
+  }
+
+  /// Returns the registry of the calling thread.
+  static thread_slot_registry &
+  local() noexcept
+  {
+    static thread_local thread_slot_registry registry;
+    return registry;
+  }
+
+  /// Returns the element of @a claims held by the calling thread, claiming a free one on first use.
+  /**
+   * \throws runtime_error If every element is held by another live thread
+   */
+  std::size_t
+  index(const std::shared_ptr<thread_slot_claims> & claims)
+  {
+    // The entry holds a reference, so its address cannot be reused while it is listed
+    for (const auto & entry : entries_) {
+      if (entry.claims == claims) {
+        return entry.index;
+      }
+    }
+    // Forget arrays which have been destroyed
+    for (std::size_t i = entries_.size(); i-- > 0;) {
+      if (entries_[i].claims.use_count() == 1) {
+        entries_.erase(entries_.begin() + static_cast<std::ptrdiff_t>(i));
+      }
+    }
+    for (std::size_t i = 0; i < claims->size; ++i) {
+      bool expected = false;
+      if (claims->claimed[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        entries_.push_back(entry{claims, i});
+        return i;
+      }
+    }
+    throw std::runtime_error("Every per-thread element is held by a live thread");
+  }
+
+private:
+  struct entry
+  {
+    std::shared_ptr<thread_slot_claims> claims;
+    std::size_t index;
+  };
+
+  std::vector<entry> entries_;
+};
+
+}  // namespace bounded_string_detail
+
+/// An %inline_bounded_basic_string aligned and padded to whole cache lines.
+/**
+ * Objects start on an @p Alignment boundary and their size is a multiple of
+ * @p Alignment, so neighbouring elements of an array never share a cache line
+ * and writes from different threads do not false-share. Use 128 on targets
+ * whose prefetcher pulls in cache lines in pairs.
+ *
+ * \tparam CharT Type of character
+ * \tparam UpperBound The upper bound for the number of characters
+ * \tparam Alignment The alignment and padding granularity in bytes, defaults to one cache line
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  std::size_t Alignment = bounded_string_cache_line_size,
+  typename Traits = std::char_traits<CharT>
+>
+class alignas(Alignment) aligned_bounded_basic_string
+  : public inline_bounded_basic_string<CharT, UpperBound, Traits>
+{
+  using Base = inline_bounded_basic_string<CharT, UpperBound, Traits>;
+
+  static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+  static_assert(Alignment >= alignof(Base), "Alignment must not weaken the natural alignment");
+
+public:
+  using Base::Base;
+  using Base::operator=;
+
+  aligned_bounded_basic_string() noexcept = default;
+};
+
+/// An %aligned_bounded_basic_string of char.
+template<
+  std::size_t UpperBound,
+  std::size_t Alignment = bounded_string_cache_line_size
+>
+using aligned_bounded_string = aligned_bounded_basic_string<char, UpperBound, Alignment>;
+
+/// A fixed-size array with one element per thread, each on its own cache lines.
+/**
+ * Works for any element type, including the heap-backed bounded_basic_string,
+ * whose object (and small-string buffer) would otherwise share cache lines
+ * with its neighbours.
+ *
+ * \tparam T The element type
+ * \tparam Alignment The alignment and padding granularity in bytes, defaults to one cache line
+ */
+template<
+  typename T,
+  std::size_t Alignment = bounded_string_cache_line_size
+>
+class per_thread_array
+{
+  struct alignas(Alignment) slot
+  {
+    T value;
+  };
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /// Create an array of @a count default-constructed elements.
+  explicit
+  per_thread_array(size_type count)
+  : slots_(std::make_unique<slot[]>(count)),
+    claims_(std::make_shared<bounded_string_detail::thread_slot_claims>(count)),
+    size_(count)
+  {}
+
+  size_type size() const noexcept { return size_; }
+  T & operator[](size_type index) noexcept { return slots_[index].value; }
+  const T & operator[](size_type index) const noexcept { return slots_[index].value; }
+
+  /// Returns the element of the calling thread.
+  /**
+   * On its first call from a thread, claims an element no live thread holds;
+   * the claim is released when the thread exits, and the element, with its
+   * contents, may then be handed to a new thread.
+   *
+   * \throws runtime_error If all size() elements are held by live threads
+   */
+  T &
+  local()
+  {
+    return slots_[bounded_string_detail::thread_slot_registry::local().index(claims_)].value;
+  }
+
+  /// Calls @a fn on every element in order.
+  template<
+    typename Fn
+  >
+  void
+  for_each(Fn && fn) const
+  {
+    for (size_type i = 0; i < size_; ++i) {
+      fn(static_cast<const T &>(slots_[i].value));
+    }
+  }
+
+private:
+  std::unique_ptr<slot[]> slots_;
+  std::shared_ptr<bounded_string_detail::thread_slot_claims> claims_;
+  size_type size_;
+};
+
+#endif /* ALIGNED_BOUNDED_STRING_HPP */
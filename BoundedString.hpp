@@ -3,7 +3,7 @@
 
 #include <algorithm>
 #include <cstddef>
-#include <iostream>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <stdexcept>
@@ -12,6 +12,34 @@
 #include <type_traits>
 #include <utility>
 
+#include "BoundedStringDiagnostics.hpp"
+#include "BoundedStringError.hpp"
+#include "BoundedStringProbes.hpp"
+#include "BoundedStringSimd.hpp"
+
+namespace bounded_string_detail
+{
+
+/// Whether @a It is an iterator which can be read more than once, so that a range can be measured first.
+template<
+  typename It,
+  typename = void
+>
+inline constexpr bool is_forward_iterator_v = false;
+
+template<
+  typename It
+>
+inline constexpr bool is_forward_iterator_v<It,
+  std::void_t<typename std::iterator_traits<It>::iterator_category>> =
+  std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>;
+
+}  // namespace bounded_string_detail
+
+#if defined(BOUNDED_STRING_HISTOGRAM)
+#include "BoundedStringHistogram.hpp"
+#endif
+
 /// A string based on std::basic_string but with an upper bound.
 /**
  * Meets the same requirements as std::basic_string.
@@ -49,6 +77,7 @@ public:
   using typename Base::const_iterator;          // Legacy[RandomAccess,Contiguous]Iterator to const value_type
   using typename Base::reverse_iterator;        // std::reverse_iterator<iterator>
   using typename Base::const_reverse_iterator;  // std::reverse_iterator<const_iterator>
+  using view_type = std::basic_string_view<CharT, Traits>;
 
   // Constructors
   /// Create an empty %bounded_basic_string object.
@@ -56,7 +85,7 @@ public:
   noexcept (noexcept(Allocator()))
   : Base()
   {
-    std::cout << "bounded_basic_string: " << UpperBound << '\n';
+    constructed();
   }
 
   /// Create an empty %bounded_basic_string object.
@@ -68,7 +97,9 @@ public:
     const Allocator & alloc)
   noexcept
   : Base(alloc)
-  {}
+  {
+    constructed();
+  }
 
   /// Create a %bounded_basic_string object with default characters.
   /**
@@ -82,12 +113,11 @@ public:
   bounded_basic_string(
     typename Base::size_type count,
     CharT ch,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(count, ch, alloc)
   {
-    if (count > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(count BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// Create a %bounded_basic_string as a substring of a provided string.
@@ -102,12 +132,11 @@ public:
   bounded_basic_string(
     const bounded_basic_string& other,
     typename Base::size_type pos,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(other, pos, alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// Create a %bounded_basic_string as a substring of a provided string.
@@ -127,12 +156,11 @@ public:
     const bounded_basic_string& other,
     typename Base::size_type pos,
     typename Base::size_type count,
-    const Allocator & alloc = Allocator())
-  : Base(other, pos, alloc)
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
+  : Base(other, pos, count, alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// Create a %bounded_basic_string with the first count characters of a pointed string.
@@ -144,12 +172,11 @@ public:
   bounded_basic_string(
     const CharT* s,
     typename Base::size_type count,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(s, count, alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// Constructs a %bounded_basic_string using the contents of a null-terminated character string.
@@ -160,13 +187,12 @@ public:
    */
   bounded_basic_string(
     const CharT* s,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(s, alloc)
   {
     // or should this be Traits::length(s) > UpperBound?
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// Create a %bounded_basic_string from a range.
@@ -184,12 +210,11 @@ public:
   bounded_basic_string(
     InputIterator first,
     InputIterator last,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(first, last, alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// %bounded_basic_string copy constructor.
@@ -202,12 +227,11 @@ public:
    */
   bounded_basic_string(
     const bounded_basic_string & other,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(other, alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// %bounded_basic_string move constructor.
@@ -225,9 +249,8 @@ public:
   noexcept
   : Base(std::move(other), alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    // other has the same bound, so there is nothing to check
+    constructed();
   }
 
 
@@ -241,12 +264,11 @@ public:
    */
   bounded_basic_string(
     std::initializer_list<CharT> ilist,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(ilist, alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// Create a %bounded_basic_string from something that could be converted to a string view.
@@ -263,12 +285,11 @@ public:
   explicit
   bounded_basic_string(
     const StringViewLike & t,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(t, alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// Create a %bounded_basic_string from a subet of something that can be converted to string view.
@@ -289,12 +310,11 @@ public:
     const StringViewLike & t,
     typename Base::size_type pos,
     typename Base::size_type n,
-    const Allocator & alloc = Allocator())
+    const Allocator & alloc = Allocator() BOUNDED_STRING_CALLER_PARAM)
   : Base(t, pos, n, alloc)
   {
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    check_bound(size() BOUNDED_STRING_CALLER_ARG);
+    constructed();
   }
 
   /// bounded_basic_string cannot be constructed from nullptr.
@@ -316,7 +336,9 @@ public:
   bounded_basic_string &
   operator=(const bounded_basic_string & str)
   {
+    const allocation_probe probe(*this);
     (void)Base::operator=(str);
+    assigned();
     return *this;
   }
 
@@ -332,7 +354,9 @@ public:
   operator=(const bounded_basic_string && str)
   noexcept
   {
+    const allocation_probe probe(*this);
     (void)Base::operator=(std::move(str));
+    assigned();
     return *this;
   }
 
@@ -347,10 +371,10 @@ public:
   bounded_basic_string &
   operator=(const CharT * s)
   {
-    if (Traits::length(s) > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(Traits::length(s));
     (void)Base::operator=(s);
+    assigned();
     return *this;
   }
 
@@ -364,9 +388,11 @@ public:
   bounded_basic_string &
   operator=(CharT ch)
   {
+    const allocation_probe probe(*this);
     // No length check required since UpperBound > 0
     // This function is probably not necessary? Base definition should suffice
     (void)Base::operator=(ch);
+    assigned();
     return *this;
   }
 
@@ -381,10 +407,10 @@ public:
   bounded_basic_string &
   operator=(std::initializer_list<CharT> ilist)
   {
-    if (ilist.size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(ilist.size());
     (void)Base::operator=(ilist);
+    assigned();
     return *this;
   }
 
@@ -403,10 +429,11 @@ public:
   bounded_basic_string &
   operator=(const StringViewLike & t)
   {
-    (void)Base::operator=(t);
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    const view_type sv = t;
+    check_bound(sv.size());
+    (void)Base::operator=(sv);
+    assigned();
     return *this;
   }
 
@@ -420,12 +447,12 @@ public:
    * \throws length_error If @a count > @p UpperBound
    */
   bounded_basic_string &
-  assign(typename Base::size_type count, CharT ch)
+  assign(typename Base::size_type count, CharT ch BOUNDED_STRING_CALLER_PARAM)
   {
-    if (count > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(count BOUNDED_STRING_CALLER_ARG);
     (void)Base::assign(count, ch);
+    assigned();
     return *this;
   }
 
@@ -438,12 +465,12 @@ public:
    * \throws length_error If the copied string is longer than @p UpperBound
    */
   bounded_basic_string &
-  assign(const bounded_basic_string & str)
+  assign(const bounded_basic_string & str BOUNDED_STRING_CALLER_PARAM)
   {
-    if (str.size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(str.size() BOUNDED_STRING_CALLER_ARG);
     (void)Base::assign(str);
+    assigned();
     return *this;
   }
 
@@ -460,12 +487,12 @@ public:
   bounded_basic_string &
   assign(const bounded_basic_string & str,
     typename Base::size_type pos,
-    typename Base::size_type count = Base::npos)
+    typename Base::size_type count = Base::npos BOUNDED_STRING_CALLER_PARAM)
   {
+    const allocation_probe probe(*this);
+    check_bound(substring_length(str, pos, count) BOUNDED_STRING_CALLER_ARG);
     (void)Base::assign(str, pos, count);
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    assigned();
     return *this;
   }
 
@@ -475,16 +502,14 @@ public:
    *
    * \param str The string to move from
    * \return L-value reference to *this
-   * \throws length_error If the string to be moved is longer than @p UpperBound
    */
   bounded_basic_string &
   assign(bounded_basic_string && str)
   noexcept
   {
-    if (str.size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    // str has the same bound, so there is nothing to check
     (void)Base::assign(std::move(str));
+    assigned();
     return *this;
   }
 
@@ -499,12 +524,12 @@ public:
    *
    */
   bounded_basic_string &
-  assign(const CharT * s, typename Base::size_type count)
+  assign(const CharT * s, typename Base::size_type count BOUNDED_STRING_CALLER_PARAM)
   {
-    if (count > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(count BOUNDED_STRING_CALLER_ARG);
     (void)Base::assign(s, count);
+    assigned();
     return *this;
   }
 
@@ -517,12 +542,12 @@ public:
    * \throws length_error If the string pointed to by @a s is longer than @p UpperBound characters
    */
   bounded_basic_string &
-  assign(const CharT * s)
+  assign(const CharT * s BOUNDED_STRING_CALLER_PARAM)
   {
-    if (Traits::length(s) > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(Traits::length(s) BOUNDED_STRING_CALLER_ARG);
     (void)Base::assign(s);
+    assigned();
     return *this;
   }
 
@@ -540,12 +565,20 @@ public:
   >
   bounded_basic_string &
   assign(InputIterator first,
-    InputIterator last)
+    InputIterator last BOUNDED_STRING_CALLER_PARAM)
   {
-    (void)Base::assign(first, last);
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
+    const allocation_probe probe(*this);
+    if constexpr (bounded_string_detail::is_forward_iterator_v<InputIterator>) {
+      check_bound(static_cast<typename Base::size_type>(std::distance(first, last))
+        BOUNDED_STRING_CALLER_ARG);
+      (void)Base::assign(first, last);
+    } else {
+      // A single-pass range can only be measured by reading it
+      Base copy(first, last, Base::get_allocator());
+      check_bound(copy.size() BOUNDED_STRING_CALLER_ARG);
+      Base::swap(copy);
     }
+    assigned();
     return *this;
   }
 
@@ -558,12 +591,12 @@ public:
    * \throws length_error If the initializer list is longer than @p UpperBound
    */
   bounded_basic_string &
-  assign(std::initializer_list<CharT> ilist)
+  assign(std::initializer_list<CharT> ilist BOUNDED_STRING_CALLER_PARAM)
   {
-    if (ilist.size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(ilist.size() BOUNDED_STRING_CALLER_ARG);
     (void)Base::assign(ilist);
+    assigned();
     return *this;
   }
 
@@ -580,12 +613,13 @@ public:
     typename StringViewLike
   >
   bounded_basic_string &
-  assign(const StringViewLike & t)
+  assign(const StringViewLike & t BOUNDED_STRING_CALLER_PARAM)
   {
-    (void)Base::assign(t);
-    if (size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    const view_type sv = t;
+    check_bound(sv.size() BOUNDED_STRING_CALLER_ARG);
+    (void)Base::assign(sv);
+    assigned();
     return *this;
   }
 
@@ -607,12 +641,13 @@ public:
   bounded_basic_string &
   assign(const StringViewLike & t,
     typename Base::size_type pos,
-    typename Base::size_type count = Base::npos)
+    typename Base::size_type count = Base::npos BOUNDED_STRING_CALLER_PARAM)
   {
-    (void)Base::assign(t, pos, count);
-    if (this->length() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    const view_type sv = t;
+    check_bound(substring_length(sv, pos, count) BOUNDED_STRING_CALLER_ARG);
+    (void)Base::assign(sv, pos, count);
+    assigned();
     return *this;
   }
 
@@ -636,11 +671,10 @@ public:
    * TODO
    */
   void
-  reserve(typename Base::size_type new_cap = 0)
+  reserve(typename Base::size_type new_cap = 0 BOUNDED_STRING_CALLER_PARAM)
   {
-    if (new_cap > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(new_cap BOUNDED_STRING_CALLER_ARG);
     Base::reserve(new_cap);
   }
 
@@ -677,17 +711,16 @@ public:
   using Base::substr;
   using Base::copy;
 
-  /// TODO
-  /*
-   * TODO
+  /// Exchanges the contents with those of @a other.
+  /**
+   * Both strings have the same bound, so neither can end up too long.
+   *
+   * \param other The string to exchange contents with
    */
   void
   swap(bounded_basic_string & other)
   noexcept
   {
-    if (other -> length() >= UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
     Base::swap(other);
   }
 
@@ -696,12 +729,12 @@ public:
    * TODO
    */
   void
-  push_back(CharT ch)
+  push_back(CharT ch BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this -> length() >= UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(this->length() + 1 BOUNDED_STRING_CALLER_ARG);
     Base::push_back(ch);
+    mutated();
   }
 
   /// TODO
@@ -711,12 +744,12 @@ public:
   bounded_basic_string &
   insert(typename Base::size_type index,
     typename Base::size_type count,
-    CharT ch)
+    CharT ch BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() + count > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(this->length() + count BOUNDED_STRING_CALLER_ARG);
     (void)Base::insert(index, count, ch);
+    mutated();
     return *this;
   }
 
@@ -726,12 +759,12 @@ public:
    */
   bounded_basic_string &
   insert(typename Base::size_type index,
-    const CharT * s)
+    const CharT * s BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() + Traits::length(s) > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(this->length() + Traits::length(s) BOUNDED_STRING_CALLER_ARG);
     (void)Base::insert(index, s);
+    mutated();
     return *this;
   }
 
@@ -742,12 +775,12 @@ public:
   bounded_basic_string &
   insert(typename Base::size_type index,
     const CharT * s,
-    typename Base::size_type count)
+    typename Base::size_type count BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() + count > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(this->length() + count BOUNDED_STRING_CALLER_ARG);
     (void)Base::insert(index, s, count);
+    mutated();
     return *this;
   }
 
@@ -757,12 +790,12 @@ public:
    */
   bounded_basic_string &
   insert(typename Base::size_type index,
-    const bounded_basic_string & str)
+    const bounded_basic_string & str BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() + str.length() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(this->length() + str.length() BOUNDED_STRING_CALLER_ARG);
     (void)Base::insert(index, str);
+    mutated();
     return *this;
   }
 
@@ -774,12 +807,12 @@ public:
   insert(typename Base::size_type index,
     const bounded_basic_string & str,
     typename Base::size_type index_str,
-    typename Base::size_type count = Base::npos)
+    typename Base::size_type count = Base::npos BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() + str.substr(index_str, count).length() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    check_bound(this->length() + substring_length(str, index_str, count) BOUNDED_STRING_CALLER_ARG);
     (void)Base::insert(index, str, index_str, count);
+    mutated();
     return *this;
   }
 
@@ -790,12 +823,13 @@ public:
   typename Base::iterator
   insert(
     typename Base::const_iterator pos,
-    CharT ch)
+    CharT ch BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() >= UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
-    return Base::insert(pos, ch);
+    const allocation_probe probe(*this);
+    check_bound(this->length() + 1 BOUNDED_STRING_CALLER_ARG);
+    const typename Base::iterator it = Base::insert(pos, ch);
+    mutated();
+    return it;
   }
 
   /// TODO
@@ -806,12 +840,13 @@ public:
   insert(
     typename Base::const_iterator pos,
     typename Base::size_type count,
-    CharT ch)
+    CharT ch BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() + count > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
-    return Base::insert(pos, count, ch);
+    const allocation_probe probe(*this);
+    check_bound(this->length() + count BOUNDED_STRING_CALLER_ARG);
+    const typename Base::iterator it = Base::insert(pos, count, ch);
+    mutated();
+    return it;
   }
 
   /// TODO
@@ -825,12 +860,23 @@ public:
   insert(
     typename Base::const_iterator pos,
     InputIterator first,
-    InputIterator last)
+    InputIterator last BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() + std::distance(first, last) > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
+    const allocation_probe probe(*this);
+    if constexpr (bounded_string_detail::is_forward_iterator_v<InputIterator>) {
+      check_bound(this->length() + static_cast<typename Base::size_type>(std::distance(first, last))
+        BOUNDED_STRING_CALLER_ARG);
+      const typename Base::iterator it = Base::insert(pos, first, last);
+      mutated();
+      return it;
+    } else {
+      // A single-pass range can only be measured by reading it
+      const Base copy(first, last, Base::get_allocator());
+      check_bound(this->length() + copy.size() BOUNDED_STRING_CALLER_ARG);
+      const typename Base::iterator it = Base::insert(pos, copy.begin(), copy.end());
+      mutated();
+      return it;
     }
-    return Base::insert(pos, first, last);
   }
 
   /// TODO
@@ -840,12 +886,13 @@ public:
   typename Base::iterator
   insert(
     typename Base::const_iterator pos,
-    std::initializer_list<CharT> ilist)
+    std::initializer_list<CharT> ilist BOUNDED_STRING_CALLER_PARAM)
   {
-    if (this->length() + ilist.size() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
-    return Base::insert(pos, ilist);
+    const allocation_probe probe(*this);
+    check_bound(this->length() + ilist.size() BOUNDED_STRING_CALLER_ARG);
+    const typename Base::iterator it = Base::insert(pos, ilist);
+    mutated();
+    return it;
   }
 
   /// TODO
@@ -858,12 +905,13 @@ public:
   bounded_basic_string &
   insert(
     typename Base::size_type pos,
-    const T & t)
+    const T & t BOUNDED_STRING_CALLER_PARAM)
   {
-    (void)Base::insert(pos, t);
-    if (this->length() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    const view_type sv = t;
+    check_bound(this->length() + sv.size() BOUNDED_STRING_CALLER_ARG);
+    (void)Base::insert(pos, sv);
+    mutated();
     return *this;
   }
 
@@ -879,15 +927,127 @@ public:
     typename Base::size_type index,
     const T & t,
     typename Base::size_type index_str,
-    typename Base::size_type count = Base::npos)
+    typename Base::size_type count = Base::npos BOUNDED_STRING_CALLER_PARAM)
   {
-    (void)Base::insert(index, t, index_str, count);
-    if (this->length() > UpperBound) {
-      throw std::length_error("Exceeded upper bound");
-    }
+    const allocation_probe probe(*this);
+    const view_type sv = t;
+    check_bound(this->length() + substring_length(sv, index_str, count) BOUNDED_STRING_CALLER_ARG);
+    (void)Base::insert(index, sv, index_str, count);
+    mutated();
     return *this;
   }
 
+  /// Converts ASCII upper case letters to lower case; all other characters are left alone.
+  /**
+   * The length does not change, so there is no bound check. Requires a
+   * single-byte character type; bytes of multi-byte UTF-8 sequences are
+   * never changed.
+   */
+  void
+  to_lower()
+  noexcept
+  {
+    static_assert(sizeof(CharT) == 1, "ASCII case conversion needs a single-byte character type");
+    bounded_string_detail::ascii_to_lower(reinterpret_cast<char *>(Base::data()), this->size());
+  }
+
+  /// Converts ASCII lower case letters to upper case; all other characters are left alone.
+  void
+  to_upper()
+  noexcept
+  {
+    static_assert(sizeof(CharT) == 1, "ASCII case conversion needs a single-byte character type");
+    bounded_string_detail::ascii_to_upper(reinterpret_cast<char *>(Base::data()), this->size());
+  }
+
+  /// Folds ASCII letters to one case for caseless comparison.
+  /**
+   * Two strings which differ only in the case of ASCII letters are equal
+   * after folding. Folding maps to lower case, as Unicode simple case
+   * folding does for ASCII; non-ASCII characters are not folded.
+   */
+  void
+  casefold_ascii()
+  noexcept
+  {
+    to_lower();
+  }
+
+  /// Removes leading and trailing whitespace (" \t\n\v\f\r").
+  /**
+   * Both ends are scanned a vector at a time for single-byte characters, and
+   * the characters kept are moved at most once.
+   */
+  void
+  trim()
+  noexcept
+  {
+    rtrim();
+    ltrim();
+  }
+
+  /// Removes leading whitespace.
+  void
+  ltrim()
+  noexcept
+  {
+    erase_front(bounded_string_detail::trim_prefix(Base::data(), this->size()));
+  }
+
+  /// Removes trailing whitespace.
+  void
+  rtrim()
+  noexcept
+  {
+    erase_back(bounded_string_detail::trim_suffix(Base::data(), this->size()));
+  }
+
+  /// Removes leading and trailing characters which appear in @a chars.
+  void
+  trim(view_type chars)
+  noexcept
+  {
+    rtrim(chars);
+    ltrim(chars);
+  }
+
+  /// Removes leading characters which appear in @a chars.
+  void
+  ltrim(view_type chars)
+  noexcept
+  {
+    erase_front(bounded_string_detail::trim_prefix<Traits>(Base::data(), this->size(), chars.data(), chars.size()));
+  }
+
+  /// Removes trailing characters which appear in @a chars.
+  void
+  rtrim(view_type chars)
+  noexcept
+  {
+    erase_back(bounded_string_detail::trim_suffix<Traits>(Base::data(), this->size(), chars.data(), chars.size()));
+  }
+
+  /// Returns a view of the string without leading and trailing whitespace; nothing is copied.
+  view_type
+  trimmed_view() const
+  noexcept
+  {
+    const typename Base::size_type front = bounded_string_detail::trim_prefix(Base::data(), this->size());
+    const typename Base::size_type count = this->size() - front;
+    return view_type(Base::data() + front, count - bounded_string_detail::trim_suffix(Base::data() + front, count));
+  }
+
+  /// Returns a view of the string without leading and trailing characters which appear in @a chars.
+  view_type
+  trimmed_view(view_type chars) const
+  noexcept
+  {
+    const typename Base::size_type front = bounded_string_detail::trim_prefix<Traits>(Base::data(), this->size(), chars.data(), chars.size());
+    const typename Base::size_type count = this->size() - front;
+    return view_type(Base::data() + front,
+      count - bounded_string_detail::trim_suffix<Traits>(Base::data() + front, count, chars.data(), chars.size()));
+  }
+
   // TODO - search
   using Base::find;
   using Base::rfind;
@@ -908,6 +1068,198 @@ public:
   // TODO - literals
 
   // TODO - helper classes (hashing)
+
+private:
+  using diagnostics = bounded_string_diagnostics<bounded_basic_string>;
+
+  /// The length of the substring [@a pos, @a pos + @a count) of @a sv.
+  /**
+   * 0 if @a pos is past the end, in which case the operation copying the
+   * substring throws std::out_of_range itself.
+   */
+  static typename Base::size_type
+  substring_length(view_type sv, typename Base::size_type pos, typename Base::size_type count)
+  noexcept
+  {
+    return pos > sv.size() ? 0 : std::min(count, sv.size() - pos);
+  }
+
+  /// Removes the first @a count characters, moving the rest only if there is anything to remove.
+  void
+  erase_front(typename Base::size_type count)
+  noexcept
+  {
+    if (count != 0) {
+      (void)Base::erase(0, count);
+    }
+  }
+
+  /// Removes the last @a count characters.
+  void
+  erase_back(typename Base::size_type count)
+  noexcept
+  {
+    (void)Base::erase(this->size() - count);
+  }
+
+  /// Records size() in the length histogram of this type, if BOUNDED_STRING_HISTOGRAM is defined.
+  void
+  record_length() const
+  noexcept
+  {
+#if defined(BOUNDED_STRING_HISTOGRAM)
+    bounded_string_length_histogram<bounded_basic_string, UpperBound>::record(this->size());
+#endif
+  }
+
+#if defined(BOUNDED_STRING_PROBES_ENABLED)
+  /// Fires the alloc or realloc probe if a member moved the characters to a new heap buffer.
+  class allocation_probe
+  {
+  public:
+    explicit
+    allocation_probe(const bounded_basic_string & s)
+    noexcept
+    : s_(s),
+      data_(s.data()),
+      capacity_(s.capacity()),
+      on_heap_(s.on_heap())
+    {}
+
+    ~allocation_probe()
+    {
+      if (s_.data() == data_ || !s_.on_heap()) {
+        return;
+      }
+      if (on_heap_) {
+        BOUNDED_STRING_PROBE3(realloc, capacity_, s_.capacity(), UpperBound);
+      } else {
+        BOUNDED_STRING_PROBE3(alloc, s_.capacity(), s_.size(), UpperBound);
+      }
+    }
+
+  private:
+    const bounded_basic_string & s_;
+    const CharT * data_;
+    typename Base::size_type capacity_;
+    bool on_heap_;
+  };
+
+  /// Whether the characters are stored outside the object.
+  bool
+  on_heap() const
+  noexcept
+  {
+    const auto self = reinterpret_cast<std::uintptr_t>(this);
+    const auto chars = reinterpret_cast<std::uintptr_t>(this->data());
+    return chars < self || chars >= self + sizeof(*this);
+  }
+#else
+  struct allocation_probe
+  {
+    explicit
+    allocation_probe(const bounded_basic_string &)
+    noexcept
+    {}
+  };
+#endif
+
+  /// Reports the end of a constructor.
+  void
+  constructed() const
+  noexcept
+  {
+#if defined(BOUNDED_STRING_PROBES_ENABLED)
+    if (on_heap()) {
+      BOUNDED_STRING_PROBE3(alloc, this->capacity(), this->size(), UpperBound);
+    }
+#endif
+    record_length();
+    diagnostics::on_construct(*this);
+  }
+
+  /// Reports an assignment, which replaces the contents.
+  void
+  assigned() const
+  noexcept
+  {
+    record_length();
+    diagnostics::on_mutate(*this);
+  }
+
+  /// Reports an insertion.
+  void
+  mutated() const
+  noexcept
+  {
+    diagnostics::on_mutate(*this);
+  }
+
+  /// Throws std::length_error, after reporting the overflow, if @a attempted exceeds @p UpperBound.
+  /**
+   * Members which can overflow pass their own `caller` with
+   * BOUNDED_STRING_CALLER_ARG; operators, which cannot take one, report
+   * themselves through the default.
+   */
+  void
+  check_bound(typename Base::size_type attempted BOUNDED_STRING_CALLER_PARAM) const
+  {
+    if (attempted > UpperBound) {
+      overflowed(attempted);
+      BOUNDED_STRING_OVERFLOW(attempted, UpperBound, caller);
+    }
+  }
+
+  /// Reports a failed bound check, before the exception is thrown.
+  void
+  overflowed(typename Base::size_type attempted) const
+  noexcept
+  {
+    BOUNDED_STRING_PROBE2(overflow, attempted, UpperBound);
+    diagnostics::on_overflow(*this, attempted);
+  }
 };
 
+/// Returns a copy of @a s with ASCII upper case letters converted to lower case.
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits,
+  typename Allocator
+>
+bounded_basic_string<CharT, UpperBound, Traits, Allocator>
+to_lower(bounded_basic_string<CharT, UpperBound, Traits, Allocator> s)
+{
+  s.to_lower();
+  return s;
+}
+
+/// Returns a copy of @a s with ASCII lower case letters converted to upper case.
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits,
+  typename Allocator
+>
+bounded_basic_string<CharT, UpperBound, Traits, Allocator>
+to_upper(bounded_basic_string<CharT, UpperBound, Traits, Allocator> s)
+{
+  s.to_upper();
+  return s;
+}
+
+/// Returns a copy of @a s with ASCII letters folded for caseless comparison.
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits,
+  typename Allocator
+>
+bounded_basic_string<CharT, UpperBound, Traits, Allocator>
+casefold_ascii(bounded_basic_string<CharT, UpperBound, Traits, Allocator> s)
+{
+  s.casefold_ascii();
+  return s;
+}
+
 #endif /* BOUNDED_STRING_HPP */
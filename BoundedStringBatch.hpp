@@ -0,0 +1,372 @@
+#ifndef BOUNDED_STRING_BATCH_HPP
+#define BOUNDED_STRING_BATCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "BoundedString.hpp"
+#include "BoundedStringSimd.hpp"
+
+/// A fixed set of worker threads which run index ranges in parallel.
+/**
+ * The calling thread takes part in every parallel_for, so a pool created for
+ * N threads starts N - 1 workers. Work is handed out in chunks through one
+ * shared counter; calls to parallel_for from different threads are serialised.
+ * A parallel_for issued from inside a chunk of any pool runs its chunks on the
+ * calling thread: waiting for this or another pool could close a cycle of
+ * pools each blocked on the other's running call.
+ */
+class bounded_string_thread_pool
+{
+public:
+  using size_type = std::size_t;
+
+  /// Create a pool which runs work on @a threads threads, including the caller.
+  explicit
+  bounded_string_thread_pool(unsigned threads = std::max(1U, std::thread::hardware_concurrency()))
+  {
+    for (unsigned i = 1; i < threads; ++i) {
+      workers_.emplace_back([this] { work(); });
+    }
+  }
+
+  bounded_string_thread_pool(const bounded_string_thread_pool &) = delete;
+  bounded_string_thread_pool & operator=(const bounded_string_thread_pool &) = delete;
+
+  ~bounded_string_thread_pool() noexcept
+  {
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    start_.notify_all();
+    for (auto & worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /// Returns the process-wide pool used when no pool is passed explicitly.
+  static bounded_string_thread_pool &
+  shared()
+  {
+    static bounded_string_thread_pool pool;
+    return pool;
+  }
+
+  /// Returns the number of threads work is spread over, including the caller.
+  unsigned
+  size() const noexcept
+  {
+    return static_cast<unsigned>(workers_.size()) + 1;
+  }
+
+  /// Calls @a fn(begin, end) for consecutive chunks of [0, @a count) in parallel.
+  /**
+   * Returns once every chunk has run. If any call throws, the remaining
+   * chunks are skipped and the first exception is rethrown here. When called
+   * from a chunk running on any pool, every chunk runs on the calling thread.
+   *
+   * \param count The number of indices
+   * \param chunk The number of indices per call
+   * \param fn Callable taking (size_type begin, size_type end)
+   */
+  template<
+    typename Fn
+  >
+  void
+  parallel_for(size_type count, size_type chunk, Fn && fn)
+  {
+    chunk = std::max<size_type>(chunk, 1);
+    if (workers_.empty() || count <= chunk || running_pool() != nullptr) {
+      for (size_type begin = 0; begin < count; begin += chunk) {
+        fn(begin, std::min(count, begin + chunk));
+      }
+      return;
+    }
+
+    const std::lock_guard<std::mutex> submit(submit_mutex_);
+    using fn_type = std::remove_reference_t<Fn>;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      job_ = job{
+        [](void * ctx, size_type begin, size_type end) { (*static_cast<fn_type *>(ctx))(begin, end); },
+        const_cast<void *>(static_cast<const void *>(&fn)), count, chunk};
+      next_.store(0, std::memory_order_relaxed);
+      running_ = workers_.size();
+      error_ = nullptr;
+      ++generation_;
+    }
+    start_.notify_all();
+    run_chunks();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return running_ == 0; });
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+private:
+  struct job
+  {
+    void (* invoke)(void *, size_type, size_type);
+    void * ctx;
+    size_type count;
+    size_type chunk;
+  };
+
+  /// Returns the pool whose chunk the calling thread is running, if any.
+  static const bounded_string_thread_pool *&
+  running_pool() noexcept
+  {
+    static thread_local const bounded_string_thread_pool * pool = nullptr;
+    return pool;
+  }
+
+  void
+  run_chunks() noexcept
+  {
+    const bounded_string_thread_pool * const outer = running_pool();
+    running_pool() = this;
+    for (;;) {
+      const size_type begin = next_.fetch_add(job_.chunk, std::memory_order_relaxed);
+      if (begin >= job_.count) {
+        running_pool() = outer;
+        return;
+      }
+      try {
+        job_.invoke(job_.ctx, begin, std::min(job_.count, begin + job_.chunk));
+      } catch (...) {
+        next_.store(job_.count, std::memory_order_relaxed);
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+          error_ = std::current_exception();
+        }
+      }
+    }
+  }
+
+  void
+  work() noexcept
+  {
+    std::uint64_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        start_.wait(lock, [this, seen] { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+          return;
+        }
+        seen = generation_;
+      }
+      run_chunks();
+      {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        --running_;
+      }
+      done_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex submit_mutex_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  job job_{};
+  std::atomic<size_type> next_{0};
+  size_type running_ = 0;
+  std::uint64_t generation_ = 0;
+  bool stopping_ = false;
+  std::exception_ptr error_;
+};
+
+/// Batch operations over arrays of bounded strings.
+/**
+ * Every function takes a pointer to @a count strings of one type, which may be
+ * any bounded string with one-byte characters (bounded_basic_string or
+ * inline_bounded_basic_string). The array is split by index into chunks of
+ * roughly chunk_bytes and the chunks are spread over a thread pool; within a
+ * chunk each string is processed with the vector kernels from
+ * BoundedStringSimd.hpp, except by translate, which is a scalar table lookup.
+ * Results go to caller-provided output arrays of @a count elements.
+ */
+namespace bounded_string_batch
+{
+
+/// Target number of bytes of strings per chunk, about half a typical L2 cache.
+inline constexpr std::size_t chunk_bytes = 128 * 1024;
+
+/// The most bytes one @p String can occupy, counting characters stored outside the object.
+template<
+  typename String
+>
+inline constexpr std::size_t footprint_v = sizeof(String);
+
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits,
+  typename Allocator
+>
+inline constexpr std::size_t footprint_v<bounded_basic_string<CharT, UpperBound, Traits, Allocator>> =
+  sizeof(bounded_basic_string<CharT, UpperBound, Traits, Allocator>) + (UpperBound + 1) * sizeof(CharT);
+
+template<
+  typename String
+>
+constexpr std::size_t
+chunk_size() noexcept
+{
+  static_assert(sizeof(typename String::value_type) == 1,
+    "batch operations work on one-byte characters");
+  return std::max<std::size_t>(1, chunk_bytes / footprint_v<String>);
+}
+
+/// Returns the characters of @a str as char, which the kernels work on.
+template<
+  typename String
+>
+char *
+bytes(String & str) noexcept
+{
+  return reinterpret_cast<char *>(str.data());
+}
+
+template<
+  typename String
+>
+const char *
+bytes(const String & str) noexcept
+{
+  return reinterpret_cast<const char *>(str.data());
+}
+
+/// Runs @a fn on every string in [@a strings, @a strings + @a count) in parallel.
+template<
+  typename String,
+  typename Fn
+>
+void
+for_each(
+  String * strings,
+  std::size_t count,
+  Fn && fn,
+  bounded_string_thread_pool & pool = bounded_string_thread_pool::shared())
+{
+  pool.parallel_for(count, chunk_size<std::remove_const_t<String>>(),
+    [strings, &fn](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        fn(strings[i], i);
+      }
+    });
+}
+
+/// Converts ASCII letters in every string to lower case.
+template<
+  typename String
+>
+void
+to_lower(
+  String * strings,
+  std::size_t count,
+  bounded_string_thread_pool & pool = bounded_string_thread_pool::shared())
+{
+  for_each(strings, count, [](String & str, std::size_t) {
+    str.to_lower();
+  }, pool);
+}
+
+/// Converts ASCII letters in every string to upper case.
+template<
+  typename String
+>
+void
+to_upper(
+  String * strings,
+  std::size_t count,
+  bounded_string_thread_pool & pool = bounded_string_thread_pool::shared())
+{
+  for_each(strings, count, [](String & str, std::size_t) {
+    str.to_upper();
+  }, pool);
+}
+
+/// Removes leading and trailing ASCII whitespace from every string.
+template<
+  typename String
+>
+void
+trim(
+  String * strings,
+  std::size_t count,
+  bounded_string_thread_pool & pool = bounded_string_thread_pool::shared())
+{
+  for_each(strings, count, [](String & str, std::size_t) {
+    str.trim();
+  }, pool);
+}
+
+/// Replaces every character c of every string with @a table[(unsigned char)c].
+template<
+  typename String
+>
+void
+translate(
+  String * strings,
+  std::size_t count,
+  const std::array<char, 256> & table,
+  bounded_string_thread_pool & pool = bounded_string_thread_pool::shared())
+{
+  for_each(strings, count, [&table](String & str, std::size_t) {
+    char * data = bytes(str);
+    for (std::size_t i = 0; i < str.size(); ++i) {
+      data[i] = table[static_cast<unsigned char>(data[i])];
+    }
+  }, pool);
+}
+
+/// Stores in @a valid[i] whether @a strings[i] is well-formed UTF-8.
+template<
+  typename String
+>
+void
+validate_utf8(
+  const String * strings,
+  std::size_t count,
+  bool * valid,
+  bounded_string_thread_pool & pool = bounded_string_thread_pool::shared())
+{
+  for_each(strings, count, [valid](const String & str, std::size_t i) {
+    valid[i] = bounded_string_detail::validate_utf8(bytes(str), str.size());
+  }, pool);
+}
+
+/// Stores in @a hashes[i] the hash of the characters of @a strings[i].
+template<
+  typename String
+>
+void
+hash(
+  const String * strings,
+  std::size_t count,
+  std::uint64_t * hashes,
+  bounded_string_thread_pool & pool = bounded_string_thread_pool::shared())
+{
+  for_each(strings, count, [hashes](const String & str, std::size_t i) {
+    hashes[i] = bounded_string_detail::hash_bytes(str.data(), str.size());
+  }, pool);
+}
+
+}  // namespace bounded_string_batch
+
+#endif /* BOUNDED_STRING_BATCH_HPP */
@@ -0,0 +1,80 @@
+#ifndef BOUNDED_STRING_DIAGNOSTICS_HPP
+#define BOUNDED_STRING_DIAGNOSTICS_HPP
+
+#include <cstddef>
+#include <cstdio>
+
+/// The diagnostics policy of a bounded string type; every hook does nothing.
+/**
+ * bounded_basic_string calls the static members of
+ * bounded_string_diagnostics<its own type> when an object is constructed,
+ * when its contents are replaced or grown by one of its checked members
+ * (assign, operator=, insert, push_back) and when a bound check fails, just
+ * before std::length_error is thrown. The hooks of the primary template are
+ * empty inline functions, so by default no code is generated for them.
+ *
+ * Specialise the template for one type to trace that type only, e.g.
+ * \code
+ * template<>
+ * struct bounded_string_diagnostics<bounded_basic_string<char, 16>>
+ *   : bounded_string_trace_diagnostics
+ * {};
+ * \endcode
+ * The specialisation must be visible wherever the type is used. Hooks must
+ * not throw.
+ *
+ * \tparam String The bounded string type
+ */
+template<
+  typename String
+>
+struct bounded_string_diagnostics
+{
+  static void
+  on_construct(const String &) noexcept
+  {}
+
+  static void
+  on_mutate(const String &) noexcept
+  {}
+
+  static void
+  on_overflow(const String &, std::size_t) noexcept
+  {}
+};
+
+/// A diagnostics policy which prints every event to stderr.
+struct bounded_string_trace_diagnostics
+{
+  template<
+    typename String
+  >
+  static void
+  on_construct(const String & s) noexcept
+  {
+    std::fprintf(stderr, "bounded string (bound %zu): constructed, size %zu\n",
+      static_cast<std::size_t>(s.max_size()), static_cast<std::size_t>(s.size()));
+  }
+
+  template<
+    typename String
+  >
+  static void
+  on_mutate(const String & s) noexcept
+  {
+    std::fprintf(stderr, "bounded string (bound %zu): modified, size %zu\n",
+      static_cast<std::size_t>(s.max_size()), static_cast<std::size_t>(s.size()));
+  }
+
+  template<
+    typename String
+  >
+  static void
+  on_overflow(const String & s, std::size_t attempted_length) noexcept
+  {
+    std::fprintf(stderr, "bounded string (bound %zu): overflow, size %zu, attempted length %zu\n",
+      static_cast<std::size_t>(s.max_size()), static_cast<std::size_t>(s.size()), attempted_length);
+  }
+};
+
+#endif /* BOUNDED_STRING_DIAGNOSTICS_HPP */
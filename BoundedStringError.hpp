@@ -0,0 +1,83 @@
+#ifndef BOUNDED_STRING_ERROR_HPP
+#define BOUNDED_STRING_ERROR_HPP
+
+#include <stdexcept>
+
+/// Marks a function as rarely called and keeps it out of line.
+/**
+ * The compiler moves such functions, and the branches leading to them, away
+ * from hot code, so a bound check costs one predicted compare and a call.
+ */
+#if defined(__GNUC__)
+#define BOUNDED_STRING_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define BOUNDED_STRING_COLD __declspec(noinline)
+#else
+#define BOUNDED_STRING_COLD
+#endif
+
+namespace bounded_string_detail
+{
+
+/// Throws the std::length_error reported when an upper bound would be exceeded.
+/**
+ * Every bound check of every string type and bound calls this one function,
+ * so a binary holds a single copy of the exception construction and throw
+ * instead of one per check per instantiation.
+ */
+[[noreturn]] BOUNDED_STRING_COLD inline void
+throw_length_error()
+{
+  throw std::length_error("Exceeded upper bound");
+}
+
+/// Throws std::length_error with @a what, for size limits other than a string's bound.
+/**
+ * Used for container capacities, e.g. of queues and logs, whose checks are
+ * just as cold as bound checks.
+ */
+[[noreturn]] BOUNDED_STRING_COLD inline void
+throw_length_error(const char * what)
+{
+  throw std::length_error(what);
+}
+
+/// Throws the std::out_of_range reported for an index past the end of a string.
+[[noreturn]] BOUNDED_STRING_COLD inline void
+throw_out_of_range()
+{
+  throw std::out_of_range("Index out of range");
+}
+
+/// Throws the std::invalid_argument reported for ill-formed UTF-8 or an invalid code point.
+[[noreturn]] BOUNDED_STRING_COLD inline void
+throw_invalid_utf8()
+{
+  throw std::invalid_argument("Invalid UTF-8");
+}
+
+}  // namespace bounded_string_detail
+
+/// Reports a failed bound check of a bounded_basic_string and throws std::length_error.
+/**
+ * BOUNDED_STRING_CALLER_PARAM is appended to the parameter list of members
+ * which can overflow and declares the defaulted source location `caller`,
+ * which such members pass as @a where, or forward with
+ * BOUNDED_STRING_CALLER_ARG to a helper declaring the same parameter.
+ * Without BOUNDED_STRING_OVERFLOW_TELEMETRY both expand to nothing,
+ * @a attempted and @a where are not evaluated and the
+ * check calls throw_length_error() with no arguments.
+ */
+#if defined(BOUNDED_STRING_OVERFLOW_TELEMETRY)
+#include "BoundedStringOverflow.hpp"
+#define BOUNDED_STRING_CALLER_PARAM , bounded_string_source_location caller = bounded_string_source_location::current()
+#define BOUNDED_STRING_CALLER_ARG , caller
+#define BOUNDED_STRING_OVERFLOW(attempted, bound, where) \
+  bounded_string_detail::throw_length_error((attempted), (bound), (where))
+#else
+#define BOUNDED_STRING_CALLER_PARAM
+#define BOUNDED_STRING_CALLER_ARG
+#define BOUNDED_STRING_OVERFLOW(attempted, bound, where) bounded_string_detail::throw_length_error()
+#endif
+
+#endif /* BOUNDED_STRING_ERROR_HPP */
@@ -0,0 +1,284 @@
+#ifndef BOUNDED_STRING_HISTOGRAM_HPP
+#define BOUNDED_STRING_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+/// Length histograms of bounded strings, recorded when BOUNDED_STRING_HISTOGRAM is defined.
+/**
+ * With the macro defined before any header of this library is included (or
+ * passed on the compiler command line), every construction and assignment of
+ * a bounded_basic_string records its resulting size() in a histogram kept
+ * per instantiation. Without it the recording calls are empty inline
+ * functions and this header is not even included.
+ *
+ * Buckets are powers of two by default. Define BOUNDED_STRING_HISTOGRAM_BUCKETS
+ * as bounded_string_linear_buckets<Width> for buckets of @a Width lengths each.
+ */
+#ifndef BOUNDED_STRING_HISTOGRAM_BUCKETS
+#define BOUNDED_STRING_HISTOGRAM_BUCKETS bounded_string_log2_buckets
+#endif
+
+/// Buckets 0, 1, [2, 4), [4, 8), ... up to the one holding the upper bound.
+struct bounded_string_log2_buckets
+{
+  static constexpr std::size_t
+  count(std::size_t upper_bound) noexcept
+  {
+    return index(upper_bound) + 1;
+  }
+
+  static constexpr std::size_t
+  index(std::size_t length) noexcept
+  {
+    std::size_t bits = 0;
+    for (; length != 0; length >>= 1U) {
+      ++bits;
+    }
+    return bits;
+  }
+
+  /// Returns the smallest length of bucket @a i.
+  static constexpr std::size_t
+  lower(std::size_t i) noexcept
+  {
+    return i == 0 ? 0 : std::size_t{1} << (i - 1);
+  }
+};
+
+/// Buckets [0, Width), [Width, 2 * Width), ... up to the one holding the upper bound.
+template<
+  std::size_t Width
+>
+struct bounded_string_linear_buckets
+{
+  static_assert(Width > 0, "bucket width must be positive");
+
+  static constexpr std::size_t
+  count(std::size_t upper_bound) noexcept
+  {
+    return index(upper_bound) + 1;
+  }
+
+  static constexpr std::size_t
+  index(std::size_t length) noexcept
+  {
+    return length / Width;
+  }
+
+  /// Returns the smallest length of bucket @a i.
+  static constexpr std::size_t
+  lower(std::size_t i) noexcept
+  {
+    return i * Width;
+  }
+};
+
+/// One bucket of a %bounded_string_length_snapshot.
+struct bounded_string_length_bucket
+{
+  /// Smallest length counted in the bucket
+  std::size_t lower = 0;
+  /// Largest length counted in the bucket, never above the upper bound
+  std::size_t upper = 0;
+  std::uint64_t count = 0;
+};
+
+/// The merged length histogram of one bounded string type.
+struct bounded_string_length_snapshot
+{
+  /// The implementation-defined name of the string type, as from std::type_info::name()
+  const char * type_name = "";
+  std::size_t upper_bound = 0;
+  std::size_t char_size = 0;
+  /// Lengths recorded
+  std::uint64_t total = 0;
+  /// Longest length recorded
+  std::size_t max_length = 0;
+  std::vector<bounded_string_length_bucket> buckets;
+
+  /// Returns the upper edge of the bucket holding the @a q quantile of recorded lengths.
+  /**
+   * For example quantile(0.99) is a bound which at least 99% of the recorded
+   * strings would have fitted in.
+   *
+   * \param q A fraction in [0, 1]
+   * \return The bucket edge, or 0 if nothing was recorded
+   */
+  std::size_t
+  quantile(double q) const noexcept
+  {
+    const auto target = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total)));
+    std::uint64_t seen = 0;
+    for (const bounded_string_length_bucket & bucket : buckets) {
+      seen += bucket.count;
+      if (bucket.count != 0 && seen >= std::max<std::uint64_t>(target, 1)) {
+        return std::min(bucket.upper, max_length);
+      }
+    }
+    return max_length;
+  }
+};
+
+namespace bounded_string_detail
+{
+
+using histogram_snapshot_fn = bounded_string_length_snapshot (*)();
+
+struct histogram_registry
+{
+  std::mutex mutex;
+  std::vector<histogram_snapshot_fn> types;
+};
+
+inline histogram_registry &
+length_histogram_registry()
+{
+  static histogram_registry registry;
+  return registry;
+}
+
+}  // namespace bounded_string_detail
+
+/// Length histogram of the strings of type @a String, sharded per thread.
+/**
+ * Each thread that records gets its own shard of counters, allocated on its
+ * first record() and registered with the type, so recording never contends:
+ * the owning thread alone writes a shard, with relaxed loads and stores and no
+ * read-modify-write. snapshot() merges all shards under a lock. Shards outlive
+ * their threads, so lengths recorded by threads that have exited still count.
+ *
+ * \tparam String The string type, which identifies the histogram
+ * \tparam UpperBound The upper bound of @a String
+ * \tparam Buckets The bucketing scheme, bounded_string_log2_buckets or bounded_string_linear_buckets
+ */
+template<
+  typename String,
+  std::size_t UpperBound,
+  typename Buckets = BOUNDED_STRING_HISTOGRAM_BUCKETS
+>
+class bounded_string_length_histogram
+{
+  static constexpr std::size_t bucket_count = Buckets::count(UpperBound);
+
+  struct shard
+  {
+    std::array<std::atomic<std::uint64_t>, bucket_count> counts{};
+    std::atomic<std::size_t> max_length{0};
+  };
+
+  struct state
+  {
+    state()
+    {
+      bounded_string_detail::histogram_registry & registry = bounded_string_detail::length_histogram_registry();
+      const std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.types.push_back(&bounded_string_length_histogram::snapshot);
+    }
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<shard>> shards;
+  };
+
+public:
+  /// Records one string of length @a length.
+  /**
+   * If the calling thread's shard cannot be allocated the length is dropped.
+   */
+  static void
+  record(std::size_t length) noexcept
+  {
+    thread_local shard * local = nullptr;
+    if (local == nullptr) {
+      local = add_shard();
+      if (local == nullptr) {
+        return;
+      }
+    }
+    std::atomic<std::uint64_t> & count = local->counts[Buckets::index(std::min(length, UpperBound))];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (length > local->max_length.load(std::memory_order_relaxed)) {
+      local->max_length.store(length, std::memory_order_relaxed);
+    }
+  }
+
+  /// Returns the histogram merged over all threads.
+  /**
+   * Lengths recorded concurrently with the call may or may not be included.
+   */
+  static bounded_string_length_snapshot
+  snapshot()
+  {
+    bounded_string_length_snapshot result;
+    result.type_name = typeid(String).name();
+    result.upper_bound = UpperBound;
+    result.char_size = sizeof(typename String::value_type);
+    result.buckets.resize(bucket_count);
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+      result.buckets[i].lower = Buckets::lower(i);
+      result.buckets[i].upper = std::min(Buckets::lower(i + 1) - 1, UpperBound);
+    }
+    state & s = shared_state();
+    const std::lock_guard<std::mutex> lock(s.mutex);
+    for (const std::unique_ptr<shard> & sh : s.shards) {
+      for (std::size_t i = 0; i < bucket_count; ++i) {
+        const std::uint64_t count = sh->counts[i].load(std::memory_order_relaxed);
+        result.buckets[i].count += count;
+        result.total += count;
+      }
+      result.max_length = std::max(result.max_length, sh->max_length.load(std::memory_order_relaxed));
+    }
+    return result;
+  }
+
+private:
+  static state &
+  shared_state()
+  {
+    static state s;
+    return s;
+  }
+
+  static shard *
+  add_shard() noexcept
+  {
+    try {
+      state & s = shared_state();
+      auto created = std::make_unique<shard>();
+      shard * raw = created.get();
+      const std::lock_guard<std::mutex> lock(s.mutex);
+      s.shards.push_back(std::move(created));
+      return raw;
+    } catch (...) {
+      return nullptr;
+    }
+  }
+};
+
+/// Returns the histograms of every string type which has recorded a length, in order of first use.
+inline std::vector<bounded_string_length_snapshot>
+bounded_string_length_histograms()
+{
+  std::vector<bounded_string_detail::histogram_snapshot_fn> types;
+  {
+    bounded_string_detail::histogram_registry & registry = bounded_string_detail::length_histogram_registry();
+    const std::lock_guard<std::mutex> lock(registry.mutex);
+    types = registry.types;
+  }
+  std::vector<bounded_string_length_snapshot> snapshots;
+  snapshots.reserve(types.size());
+  for (const bounded_string_detail::histogram_snapshot_fn fn : types) {
+    snapshots.push_back(fn());
+  }
+  return snapshots;
+}
+
+#endif /* BOUNDED_STRING_HISTOGRAM_HPP */
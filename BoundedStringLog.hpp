@@ -0,0 +1,214 @@
+#ifndef BOUNDED_STRING_LOG_HPP
+#define BOUNDED_STRING_LOG_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "BoundedStringError.hpp"
+#include "InlineBoundedString.hpp"
+
+/// A multi-producer, single-consumer append-only log of bounded string records.
+/**
+ * Records are packed back to back in one ring buffer, each as an 8 byte
+ * header followed by the characters, padded to 8 bytes. A producer reserves
+ * its record with a single fetch_add on the write offset, copies the
+ * characters in and commits by storing the length into the header.
+ *
+ * Since no record is longer than max_record_bytes, the buffer is followed by
+ * that many bytes of slack: a record which starts near the end of the ring
+ * simply runs on into the slack instead of wrapping, so records are always
+ * contiguous and never split. The consumer walks committed records in order,
+ * stops at the first one still being written, and zeroes each record it
+ * consumed so the space can be reused.
+ *
+ * \tparam CharT Type of character
+ * \tparam UpperBound The upper bound for the number of characters in a record
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits = std::char_traits<CharT>
+>
+class bounded_string_log
+{
+  static constexpr std::size_t alignment = 8;
+  static constexpr std::size_t header_bytes = 8;
+
+public:
+  using size_type = std::size_t;
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  static_assert(UpperBound > 0, "UpperBound must be positive");
+  static_assert(UpperBound < UINT32_MAX, "record lengths are stored in 32 bits");
+  static_assert(alignof(CharT) <= alignment, "characters must fit the record alignment");
+  static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+    "record headers must be lock-free atomics");
+
+  /// Returns the number of bytes a record of @a count characters occupies.
+  static constexpr size_type
+  record_bytes(size_type count) noexcept
+  {
+    return (header_bytes + count * sizeof(CharT) + alignment - 1) & ~(alignment - 1);
+  }
+
+  /// The size of the largest possible record.
+  static constexpr size_type max_record_bytes =
+    (header_bytes + UpperBound * sizeof(CharT) + alignment - 1) & ~(alignment - 1);
+
+  /// Create a log with a ring buffer of at least @a capacity bytes.
+  /**
+   * \param capacity The size of the ring buffer; rounded up to 8 bytes
+   * \throws length_error If @a capacity cannot hold the largest possible record
+   */
+  explicit
+  bounded_string_log(size_type capacity)
+  : capacity_((capacity + alignment - 1) & ~(alignment - 1)),
+    words_(std::make_unique<std::uint64_t[]>((capacity_ + max_record_bytes) / alignment))
+  {
+    if (capacity_ < max_record_bytes) {
+      bounded_string_detail::throw_length_error("Log capacity is smaller than the largest record");
+    }
+  }
+
+  bounded_string_log(const bounded_string_log &) = delete;
+  bounded_string_log & operator=(const bounded_string_log &) = delete;
+
+  /// Returns the size of the ring buffer in bytes.
+  size_type
+  capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  /// Appends a record, waiting for the consumer if the ring is full.
+  /**
+   * Safe to call from any number of threads.
+   *
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  void
+  append(view_type sv)
+  {
+    check_length(sv);
+    const size_type bytes = record_bytes(sv.size());
+    const std::uint64_t offset = tail_.fetch_add(bytes, std::memory_order_relaxed);
+    while (offset + bytes - head_.load(std::memory_order_acquire) > capacity_) {
+      std::this_thread::yield();
+    }
+    write(offset, sv);
+  }
+
+  /// Appends a record unless the ring is full.
+  /**
+   * Safe to call from any number of threads. Uses a CAS loop rather than a
+   * single fetch_add so that a full ring can be reported without reserving.
+   *
+   * \return false if there is not enough free space
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  bool
+  try_append(view_type sv)
+  {
+    check_length(sv);
+    const size_type bytes = record_bytes(sv.size());
+    std::uint64_t offset = tail_.load(std::memory_order_relaxed);
+    do {
+      if (offset + bytes - head_.load(std::memory_order_acquire) > capacity_) {
+        return false;
+      }
+    } while (!tail_.compare_exchange_weak(offset, offset + bytes, std::memory_order_relaxed));
+    write(offset, sv);
+    return true;
+  }
+
+  /// Appends the contents of any bounded string type.
+  template<
+    typename String
+  >
+  auto
+  append(const String & str)
+  -> decltype(view_type(str.data(), str.size()), void())
+  {
+    append(view_type(str.data(), str.size()));
+  }
+
+  /// Passes up to @a max committed records to @a read in order and releases their space.
+  /**
+   * Must only be called from a single consumer thread at a time. Stops early
+   * at the first record that has been reserved but not yet committed.
+   *
+   * \param read Callable taking view_type; the view is only valid during the call
+   * \param max The maximum number of records to consume
+   * \return The number of records consumed
+   */
+  template<
+    typename Read
+  >
+  size_type
+  consume(Read && read, size_type max = static_cast<size_type>(-1))
+  {
+    std::uint64_t offset = head_.load(std::memory_order_relaxed);
+    size_type count = 0;
+    for (; count < max; ++count) {
+      std::byte * record = at(offset);
+      const std::uint32_t committed = header(record).load(std::memory_order_acquire);
+      if (committed == 0) {
+        break;
+      }
+      const size_type size = committed - 1;
+      read(view_type(reinterpret_cast<const CharT *>(record + header_bytes), size));
+      // Producers rely on free space being zero, so that a header they
+      // have not committed yet never looks committed.
+      std::memset(record, 0, record_bytes(size));
+      offset += record_bytes(size);
+    }
+    if (count != 0) {
+      head_.store(offset, std::memory_order_release);
+    }
+    return count;
+  }
+
+private:
+  static void
+  check_length(view_type sv)
+  {
+    if (sv.size() > UpperBound) {
+      bounded_string_detail::throw_length_error();
+    }
+  }
+
+  static std::atomic<std::uint32_t> &
+  header(std::byte * record) noexcept
+  {
+    return *reinterpret_cast<std::atomic<std::uint32_t> *>(record);
+  }
+
+  std::byte *
+  at(std::uint64_t offset) const noexcept
+  {
+    return reinterpret_cast<std::byte *>(words_.get()) + offset % capacity_;
+  }
+
+  void
+  write(std::uint64_t offset, view_type sv) noexcept
+  {
+    std::byte * record = at(offset);
+    Traits::copy(reinterpret_cast<CharT *>(record + header_bytes), sv.data(), sv.size());
+    header(record).store(static_cast<std::uint32_t>(sv.size() + 1), std::memory_order_release);
+  }
+
+  const size_type capacity_;
+  const std::unique_ptr<std::uint64_t[]> words_;
+
+  alignas(bounded_string_cache_line_size) std::atomic<std::uint64_t> tail_{0};
+  alignas(bounded_string_cache_line_size) std::atomic<std::uint64_t> head_{0};
+};
+
+#endif /* BOUNDED_STRING_LOG_HPP */
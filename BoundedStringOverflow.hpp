@@ -0,0 +1,239 @@
+#ifndef BOUNDED_STRING_OVERFLOW_HPP
+#define BOUNDED_STRING_OVERFLOW_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<source_location>)
+#include <source_location>
+#endif
+#endif
+
+#include "BoundedStringError.hpp"
+
+/// Overflow telemetry, compiled in when BOUNDED_STRING_OVERFLOW_TELEMETRY is defined.
+/**
+ * With the macro defined before any header of this library is included (or
+ * passed on the compiler command line), every bound check of a
+ * bounded_basic_string which fails reports where it was called from, the
+ * length the operation would have produced and the upper bound before
+ * throwing std::length_error. Overflows are counted per call site, and an
+ * optional hook sees a sample of them.
+ *
+ * Constructors and the named members which can overflow (assign, insert,
+ * push_back, reserve) take a defaulted trailing source location, so the site
+ * is the caller's. Operators cannot take one; their site is inside this
+ * library and identifies the operator.
+ *
+ * Without the macro no parameter is added, this header is not included and a
+ * failing check calls the plain throw helper as before.
+ */
+
+#if defined(__cpp_lib_source_location)
+/// The location of a call; std::source_location when the standard library has it.
+using bounded_string_source_location = std::source_location;
+#else
+/// The location of a call, filled in by compiler builtins where std::source_location is unavailable.
+class bounded_string_source_location
+{
+public:
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+  static constexpr bounded_string_source_location
+  current(
+    const char * file = __builtin_FILE(),
+    const char * function = __builtin_FUNCTION(),
+    std::uint_least32_t line = __builtin_LINE())
+  noexcept
+  {
+    bounded_string_source_location location;
+    location.file_ = file;
+    location.function_ = function;
+    location.line_ = line;
+    return location;
+  }
+#else
+  static constexpr bounded_string_source_location
+  current()
+  noexcept
+  {
+    return bounded_string_source_location();
+  }
+#endif
+
+  constexpr const char *
+  file_name() const
+  noexcept
+  {
+    return file_;
+  }
+
+  constexpr const char *
+  function_name() const
+  noexcept
+  {
+    return function_;
+  }
+
+  constexpr std::uint_least32_t
+  line() const
+  noexcept
+  {
+    return line_;
+  }
+
+  /// Always 0: the column is not available without std::source_location.
+  constexpr std::uint_least32_t
+  column() const
+  noexcept
+  {
+    return 0;
+  }
+
+private:
+  const char * file_ = "";
+  const char * function_ = "";
+  std::uint_least32_t line_ = 0;
+};
+#endif
+
+/// One failed bound check.
+struct bounded_string_overflow_event
+{
+  bounded_string_source_location location;
+  /// The length the operation would have produced
+  std::size_t attempted_length = 0;
+  std::size_t upper_bound = 0;
+};
+
+/// Called on sampled overflows, before std::length_error is thrown; must not throw.
+using bounded_string_overflow_hook = void (*)(const bounded_string_overflow_event &);
+
+/// The overflow counters of one call site.
+struct bounded_string_overflow_site
+{
+  const char * file_name = "";
+  const char * function_name = "";
+  std::uint_least32_t line = 0;
+  std::uint_least32_t column = 0;
+  std::size_t upper_bound = 0;
+  /// Every overflow at the site, whether or not the hook saw it
+  std::uint64_t count = 0;
+  /// Longest length attempted at the site
+  std::size_t max_attempted_length = 0;
+};
+
+namespace bounded_string_detail
+{
+
+struct overflow_telemetry
+{
+  std::atomic<bounded_string_overflow_hook> hook{nullptr};
+  std::atomic<std::uint64_t> sample_period{1};
+  std::mutex mutex;
+  std::vector<bounded_string_overflow_site> sites;
+};
+
+inline overflow_telemetry &
+overflow_state()
+{
+  static overflow_telemetry state;
+  return state;
+}
+
+/// Counts an overflow at @a location, calls the hook if it is sampled and throws std::length_error.
+/**
+ * The one out-of-line function behind every bound check when telemetry is
+ * compiled in. Sites are found by a linear search under a mutex: this runs
+ * only when a check fails, just before an exception is thrown, and a program
+ * has few overflowing sites.
+ */
+[[noreturn]] BOUNDED_STRING_COLD inline void
+throw_length_error(
+  std::size_t attempted_length,
+  std::size_t upper_bound,
+  const bounded_string_source_location & location)
+{
+  overflow_telemetry & state = overflow_state();
+  std::uint64_t count = 0;
+  {
+    const std::lock_guard<std::mutex> lock(state.mutex);
+    bounded_string_overflow_site * site = nullptr;
+    for (bounded_string_overflow_site & s : state.sites) {
+      if (s.line == location.line() && s.column == location.column() && s.upper_bound == upper_bound &&
+          std::strcmp(s.file_name, location.file_name()) == 0 &&
+          std::strcmp(s.function_name, location.function_name()) == 0) {
+        site = &s;
+        break;
+      }
+    }
+    if (site == nullptr) {
+      bounded_string_overflow_site added;
+      added.file_name = location.file_name();
+      added.function_name = location.function_name();
+      added.line = location.line();
+      added.column = location.column();
+      added.upper_bound = upper_bound;
+      site = &state.sites.emplace_back(added);
+    }
+    count = ++site->count;
+    if (attempted_length > site->max_attempted_length) {
+      site->max_attempted_length = attempted_length;
+    }
+  }
+  const bounded_string_overflow_hook hook = state.hook.load(std::memory_order_acquire);
+  if (hook != nullptr && (count - 1) % state.sample_period.load(std::memory_order_relaxed) == 0) {
+    hook(bounded_string_overflow_event{location, attempted_length, upper_bound});
+  }
+  throw std::length_error("Exceeded upper bound");
+}
+
+}  // namespace bounded_string_detail
+
+/// Installs @a hook, or removes the current one if it is nullptr.
+/**
+ * \return The previous hook
+ */
+inline bounded_string_overflow_hook
+set_bounded_string_overflow_hook(bounded_string_overflow_hook hook) noexcept
+{
+  return bounded_string_detail::overflow_state().hook.exchange(hook, std::memory_order_acq_rel);
+}
+
+/// Makes the hook see the first overflow of each site and then every @a period-th one.
+/**
+ * The counters always count every overflow. The default period is 1.
+ *
+ * \param period The sampling period; 0 is treated as 1
+ * \return The previous period
+ */
+inline std::uint64_t
+set_bounded_string_overflow_sample_period(std::uint64_t period) noexcept
+{
+  return bounded_string_detail::overflow_state().sample_period.exchange(period == 0 ? 1 : period);
+}
+
+/// Returns the counters of every site which has overflowed, in order of first overflow.
+inline std::vector<bounded_string_overflow_site>
+bounded_string_overflow_sites()
+{
+  bounded_string_detail::overflow_telemetry & state = bounded_string_detail::overflow_state();
+  const std::lock_guard<std::mutex> lock(state.mutex);
+  return state.sites;
+}
+
+/// Forgets every site and its counters.
+inline void
+reset_bounded_string_overflow_sites()
+{
+  bounded_string_detail::overflow_telemetry & state = bounded_string_detail::overflow_state();
+  const std::lock_guard<std::mutex> lock(state.mutex);
+  state.sites.clear();
+}
+
+#endif /* BOUNDED_STRING_OVERFLOW_HPP */
@@ -0,0 +1,72 @@
+#ifndef BOUNDED_STRING_PROBES_HPP
+#define BOUNDED_STRING_PROBES_HPP
+
+#include <cstdint>
+
+/// USDT (SystemTap SDT) probes on the slow paths of bounded_basic_string.
+/**
+ * With BOUNDED_STRING_USDT defined, bounded_basic_string marks these events
+ * with static probes of provider bounded_string:
+ *
+ * - overflow(attempted_length, upper_bound): a bound check failed
+ * - alloc(capacity, size, upper_bound): the characters moved to the heap
+ * - realloc(old_capacity, new_capacity, upper_bound): the heap buffer was replaced
+ *
+ * Each probe is a single nop in the code plus an ELF note in the same format
+ * as the STAP_PROBEn macros of <sys/sdt.h>, so perf, bpftrace and SystemTap
+ * can attach to it, e.g. `bpftrace -e 'usdt:./app:bounded_string:overflow { @[arg1] = count(); }'`.
+ * Nothing is linked and, while no tracer is attached, only the probe
+ * arguments are computed. The notes are emitted with GCC-compatible inline
+ * assembly for x86-64 and AArch64 ELF targets; elsewhere, and without the
+ * macro, the probes expand to nothing.
+ */
+#if defined(BOUNDED_STRING_USDT) && defined(__GNUC__) && defined(__ELF__) && \
+  (defined(__x86_64__) || defined(__aarch64__))
+
+#define BOUNDED_STRING_PROBES_ENABLED 1
+
+// The note of one probe, as laid out by <sys/sdt.h>. "?" puts it in the
+// section group of the enclosing function, so that it is discarded with
+// duplicate inline definitions. _.stapsdt.base lets tools correct the
+// recorded address for prelinking.
+#define BOUNDED_STRING_PROBE_ASM(name, args) \
+  "990: nop\n" \
+  ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+  ".balign 4\n" \
+  ".4byte 992f-991f, 994f-993f, 3\n" \
+  "991: .asciz \"stapsdt\"\n" \
+  "992: .balign 4\n" \
+  "993: .8byte 990b\n" \
+  ".8byte _.stapsdt.base\n" \
+  ".8byte 0\n" \
+  ".asciz \"bounded_string\"\n" \
+  ".asciz \"" #name "\"\n" \
+  ".asciz \"" args "\"\n" \
+  "994: .balign 4\n" \
+  ".popsection\n" \
+  ".ifndef _.stapsdt.base\n" \
+  ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+  ".weak _.stapsdt.base\n" \
+  ".hidden _.stapsdt.base\n" \
+  "_.stapsdt.base: .space 1\n" \
+  ".size _.stapsdt.base, 1\n" \
+  ".popsection\n" \
+  ".endif\n"
+
+#define BOUNDED_STRING_PROBE2(name, a1, a2) \
+  __asm__ __volatile__(BOUNDED_STRING_PROBE_ASM(name, "8@%0 8@%1") \
+    : : "nor"(static_cast<std::uint64_t>(a1)), "nor"(static_cast<std::uint64_t>(a2)))
+
+#define BOUNDED_STRING_PROBE3(name, a1, a2, a3) \
+  __asm__ __volatile__(BOUNDED_STRING_PROBE_ASM(name, "8@%0 8@%1 8@%2") \
+    : : "nor"(static_cast<std::uint64_t>(a1)), "nor"(static_cast<std::uint64_t>(a2)), \
+      "nor"(static_cast<std::uint64_t>(a3)))
+
+#else
+
+#define BOUNDED_STRING_PROBE2(name, a1, a2) ((void)0)
+#define BOUNDED_STRING_PROBE3(name, a1, a2, a3) ((void)0)
+
+#endif
+
+#endif /* BOUNDED_STRING_PROBES_HPP */
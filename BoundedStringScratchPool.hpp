@@ -0,0 +1,182 @@
+#ifndef BOUNDED_STRING_SCRATCH_POOL_HPP
+#define BOUNDED_STRING_SCRATCH_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bounded_string_detail
+{
+
+/// Reserves the full bound up front for strings which can grow, so that they never reallocate.
+template<
+  typename String
+>
+auto
+reserve_bound(String & str, int)
+-> decltype(str.reserve(str.max_size()), void())
+{
+  str.reserve(str.max_size());
+}
+
+template<
+  typename String
+>
+void
+reserve_bound(String &, long)
+{}
+
+}  // namespace bounded_string_detail
+
+/// Per-thread counters of a %bounded_string_scratch_pool.
+struct bounded_string_scratch_stats
+{
+  /// Buffers currently handed out
+  std::size_t in_use = 0;
+  /// Most buffers handed out at the same time
+  std::size_t high_water_mark = 0;
+  /// Buffers owned by the pool, in use or free
+  std::size_t pooled = 0;
+  /// Calls to acquire()
+  std::size_t acquisitions = 0;
+};
+
+/// A thread-local LIFO pool of scratch bounded strings.
+/**
+ * Each thread keeps its own free list of heap-allocated @a String objects.
+ * acquire() hands out the most recently released buffer, cleared, wrapped in
+ * a handle which gives it back when it goes out of scope. Buffers are only
+ * allocated while a thread needs more of them at once than ever before, and
+ * strings that can grow have their full bound reserved when created, so a
+ * warmed-up pool never touches the global allocator. Large inline strings
+ * stay off the stack of deep call chains.
+ *
+ * Handles must be destroyed on the thread that acquired them, and before
+ * that thread exits.
+ *
+ * \tparam String The bounded string type to pool, e.g. bounded_basic_string<char, 4096>
+ */
+template<
+  typename String
+>
+class bounded_string_scratch_pool
+{
+  struct state
+  {
+    std::vector<std::unique_ptr<String>> free;
+    bounded_string_scratch_stats stats;
+  };
+
+public:
+  /// A scratch buffer borrowed from the calling thread's pool.
+  class handle
+  {
+  public:
+    handle(const handle &) = delete;
+    handle & operator=(const handle &) = delete;
+
+    handle(handle && other) noexcept
+    : buffer_(std::move(other.buffer_))
+    {}
+
+    handle &
+    operator=(handle && other) noexcept
+    {
+      release();
+      buffer_ = std::move(other.buffer_);
+      return *this;
+    }
+
+    ~handle() noexcept
+    {
+      release();
+    }
+
+    String & operator*() const noexcept { return *buffer_; }
+    String * operator->() const noexcept { return buffer_.get(); }
+    String * get() const noexcept { return buffer_.get(); }
+
+  private:
+    friend class bounded_string_scratch_pool;
+
+    explicit handle(std::unique_ptr<String> buffer) noexcept
+    : buffer_(std::move(buffer))
+    {}
+
+    void
+    release() noexcept
+    {
+      if (buffer_) {
+        state & local = local_state();
+        // Capacity was reserved for every pooled buffer, so this never allocates
+        local.free.push_back(std::move(buffer_));
+        --local.stats.in_use;
+      }
+    }
+
+    std::unique_ptr<String> buffer_;
+  };
+
+  /// Borrows an empty scratch string from the calling thread's pool.
+  static handle
+  acquire()
+  {
+    state & local = local_state();
+    std::unique_ptr<String> buffer;
+    if (local.free.empty()) {
+      buffer = std::make_unique<String>();
+      bounded_string_detail::reserve_bound(*buffer, 0);
+      local.free.reserve(local.stats.pooled + 1);
+      ++local.stats.pooled;
+    } else {
+      buffer = std::move(local.free.back());
+      local.free.pop_back();
+      buffer->clear();
+    }
+    ++local.stats.acquisitions;
+    ++local.stats.in_use;
+    local.stats.high_water_mark = std::max(local.stats.high_water_mark, local.stats.in_use);
+    return handle(std::move(buffer));
+  }
+
+  /// Creates buffers until at least @a count are pooled on the calling thread.
+  static void
+  reserve(std::size_t count)
+  {
+    state & local = local_state();
+    local.free.reserve(std::max(count, local.stats.pooled));
+    while (local.stats.pooled < count) {
+      auto buffer = std::make_unique<String>();
+      bounded_string_detail::reserve_bound(*buffer, 0);
+      local.free.push_back(std::move(buffer));
+      ++local.stats.pooled;
+    }
+  }
+
+  /// Returns the calling thread's counters.
+  static bounded_string_scratch_stats
+  stats() noexcept
+  {
+    return local_state().stats;
+  }
+
+  /// Resets the calling thread's high-water mark to the number of buffers in use.
+  static void
+  reset_high_water_mark() noexcept
+  {
+    state & local = local_state();
+    local.stats.high_water_mark = local.stats.in_use;
+  }
+
+private:
+  static state &
+  local_state() noexcept
+  {
+    thread_local state local;
+    return local;
+  }
+};
+
+#endif /* BOUNDED_STRING_SCRATCH_POOL_HPP */
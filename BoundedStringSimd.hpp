@@ -0,0 +1,509 @@
+#ifndef BOUNDED_STRING_SIMD_HPP
+#define BOUNDED_STRING_SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__) || defined(__AVX512BW__)
+#include <immintrin.h>
+#endif
+
+/// Character kernels shared by the bounded string types.
+/**
+ * All kernels work on raw byte ranges so that they serve every string type
+ * whose characters are one byte wide. Vector paths are selected at compile
+ * time from the target's instruction set macros; a scalar path handles the
+ * tail and targets without vector support.
+ */
+namespace bounded_string_detail
+{
+
+/// Adds @a delta to every byte of [@a first, @a first + @a count) in [@a lo, @a hi].
+/**
+ * Processes 64 bytes per step with AVX-512BW, whose masked loads and stores
+ * also cover the tail, or 32 with AVX2 and then 16 with SSE2 before a scalar
+ * tail.
+ */
+inline void
+ascii_shift_range(char * first, std::size_t count, char lo, char hi, char delta)
+noexcept
+{
+#if defined(__AVX512BW__)
+  // An unsigned compare of byte - lo against hi - lo selects [lo, hi]
+  const __m512i base = _mm512_set1_epi8(lo);
+  const __m512i span = _mm512_set1_epi8(static_cast<char>(hi - lo));
+  const __m512i shift = _mm512_set1_epi8(delta);
+  std::size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    const __m512i bytes = _mm512_loadu_si512(first + i);
+    const __mmask64 in_range = _mm512_cmple_epu8_mask(_mm512_sub_epi8(bytes, base), span);
+    _mm512_storeu_si512(first + i, _mm512_mask_add_epi8(bytes, in_range, bytes, shift));
+  }
+  if (i < count) {
+    const __mmask64 tail = ~0ULL >> (64 - (count - i));
+    const __m512i bytes = _mm512_maskz_loadu_epi8(tail, first + i);
+    const __mmask64 in_range = _mm512_mask_cmple_epu8_mask(tail, _mm512_sub_epi8(bytes, base), span);
+    _mm512_mask_storeu_epi8(first + i, in_range, _mm512_add_epi8(bytes, shift));
+  }
+#else
+  std::size_t i = 0;
+  // Signed compares against lo - 1 and hi + 1; bytes >= 0x80 are negative
+  // and never fall inside an ASCII letter range.
+#if defined(__AVX2__)
+  const __m256i below256 = _mm256_set1_epi8(static_cast<char>(lo - 1));
+  const __m256i above256 = _mm256_set1_epi8(static_cast<char>(hi + 1));
+  const __m256i shift256 = _mm256_set1_epi8(delta);
+  for (; i + 32 <= count; i += 32) {
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + i));
+    const __m256i in_range = _mm256_and_si256(
+      _mm256_cmpgt_epi8(bytes, below256), _mm256_cmpgt_epi8(above256, bytes));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(first + i),
+      _mm256_add_epi8(bytes, _mm256_and_si256(in_range, shift256)));
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i below = _mm_set1_epi8(static_cast<char>(lo - 1));
+  const __m128i above = _mm_set1_epi8(static_cast<char>(hi + 1));
+  const __m128i shift = _mm_set1_epi8(delta);
+  for (; i + 16 <= count; i += 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+    const __m128i in_range = _mm_and_si128(
+      _mm_cmpgt_epi8(bytes, below), _mm_cmplt_epi8(bytes, above));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(first + i),
+      _mm_add_epi8(bytes, _mm_and_si128(in_range, shift)));
+  }
+#endif
+  for (; i < count; ++i) {
+    if (first[i] >= lo && first[i] <= hi) {
+      first[i] = static_cast<char>(first[i] + delta);
+    }
+  }
+#endif
+}
+
+/// Converts ASCII upper case letters in [@a first, @a first + @a count) to lower case.
+inline void
+ascii_to_lower(char * first, std::size_t count)
+noexcept
+{
+  ascii_shift_range(first, count, 'A', 'Z', 'a' - 'A');
+}
+
+/// Converts ASCII lower case letters in [@a first, @a first + @a count) to upper case.
+inline void
+ascii_to_upper(char * first, std::size_t count)
+noexcept
+{
+  ascii_shift_range(first, count, 'a', 'z', static_cast<char>('A' - 'a'));
+}
+
+/// Returns true if @a ch is one of " \t\n\v\f\r".
+constexpr bool
+is_ascii_space(char ch)
+noexcept
+{
+  return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+#if defined(__SSE2__)
+/// Returns a bit per byte of the 16 bytes at @a first, set for whitespace.
+inline unsigned
+ascii_space_mask(const char * first)
+noexcept
+{
+  // '\t'..'\r' by signed compares, which bytes >= 0x80 never pass
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+  const __m128i control = _mm_and_si128(
+    _mm_cmpgt_epi8(bytes, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('\r' + 1)));
+  const __m128i space = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+  return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(control, space)));
+}
+
+/// Returns a bit per byte of the 16 bytes at @a first, set for bytes in [@a set, @a set + @a set_count).
+inline unsigned
+byte_set_mask(const char * first, const char * set, std::size_t set_count)
+noexcept
+{
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+  __m128i found = _mm_setzero_si128();
+  for (std::size_t k = 0; k < set_count; ++k) {
+    found = _mm_or_si128(found, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(set[k])));
+  }
+  return static_cast<unsigned>(_mm_movemask_epi8(found));
+}
+#endif
+
+/// Sets larger than this are matched by the scalar loop alone, one compare per member being too many.
+inline constexpr std::size_t byte_set_vector_limit = 16;
+
+/// Returns the number of leading whitespace characters in [@a first, @a first + @a count).
+inline std::size_t
+ascii_space_prefix(const char * first, std::size_t count)
+noexcept
+{
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= count; i += 16) {
+    const unsigned other = ~ascii_space_mask(first + i) & 0xFFFFU;
+    if (other != 0) {
+      return i + static_cast<std::size_t>(__builtin_ctz(other));
+    }
+  }
+#endif
+  while (i < count && is_ascii_space(first[i])) {
+    ++i;
+  }
+  return i;
+}
+
+/// Returns the number of trailing whitespace characters in [@a first, @a first + @a count).
+inline std::size_t
+ascii_space_suffix(const char * first, std::size_t count)
+noexcept
+{
+  std::size_t i = count;
+#if defined(__SSE2__)
+  for (; i >= 16; i -= 16) {
+    const unsigned other = ~ascii_space_mask(first + i - 16) & 0xFFFFU;
+    if (other != 0) {
+      // The last non-space byte is at i - 16 + 31 - clz
+      return count - (i - 16) - static_cast<std::size_t>(32 - __builtin_clz(other));
+    }
+  }
+#endif
+  while (i > 0 && is_ascii_space(first[i - 1])) {
+    --i;
+  }
+  return count - i;
+}
+
+/// Returns the number of leading bytes of [@a first, @a first + @a count) in [@a set, @a set + @a set_count).
+inline std::size_t
+byte_set_prefix(const char * first, std::size_t count, const char * set, std::size_t set_count)
+noexcept
+{
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  if (set_count <= byte_set_vector_limit) {
+    for (; i + 16 <= count; i += 16) {
+      const unsigned other = ~byte_set_mask(first + i, set, set_count) & 0xFFFFU;
+      if (other != 0) {
+        return i + static_cast<std::size_t>(__builtin_ctz(other));
+      }
+    }
+  }
+#endif
+  while (i < count && set_count != 0 && std::memchr(set, first[i], set_count) != nullptr) {
+    ++i;
+  }
+  return i;
+}
+
+/// Returns the number of trailing bytes of [@a first, @a first + @a count) in [@a set, @a set + @a set_count).
+inline std::size_t
+byte_set_suffix(const char * first, std::size_t count, const char * set, std::size_t set_count)
+noexcept
+{
+  std::size_t i = count;
+#if defined(__SSE2__)
+  if (set_count <= byte_set_vector_limit) {
+    for (; i >= 16; i -= 16) {
+      const unsigned other = ~byte_set_mask(first + i - 16, set, set_count) & 0xFFFFU;
+      if (other != 0) {
+        return count - (i - 16) - static_cast<std::size_t>(32 - __builtin_clz(other));
+      }
+    }
+  }
+#endif
+  while (i > 0 && set_count != 0 && std::memchr(set, first[i - 1], set_count) != nullptr) {
+    --i;
+  }
+  return count - i;
+}
+
+/// Returns the number of leading whitespace characters in [@a first, @a first + @a count) of any character type.
+/**
+ * Single-byte characters take the vector kernel; wider ones are compared
+ * one at a time against the same six ASCII whitespace characters.
+ */
+template<
+  typename CharT
+>
+inline std::size_t
+trim_prefix(const CharT * first, std::size_t count)
+noexcept
+{
+  if constexpr (sizeof(CharT) == 1) {
+    return ascii_space_prefix(reinterpret_cast<const char *>(first), count);
+  } else {
+    std::size_t i = 0;
+    while (i < count && (first[i] == CharT(' ') || (first[i] >= CharT('\t') && first[i] <= CharT('\r')))) {
+      ++i;
+    }
+    return i;
+  }
+}
+
+/// Returns the number of trailing whitespace characters in [@a first, @a first + @a count) of any character type.
+template<
+  typename CharT
+>
+inline std::size_t
+trim_suffix(const CharT * first, std::size_t count)
+noexcept
+{
+  if constexpr (sizeof(CharT) == 1) {
+    return ascii_space_suffix(reinterpret_cast<const char *>(first), count);
+  } else {
+    std::size_t i = count;
+    while (i > 0 && (first[i - 1] == CharT(' ') || (first[i - 1] >= CharT('\t') && first[i - 1] <= CharT('\r')))) {
+      --i;
+    }
+    return count - i;
+  }
+}
+
+/// Returns the number of leading characters of [@a first, @a first + @a count) in [@a set, @a set + @a set_count).
+template<
+  typename Traits,
+  typename CharT
+>
+inline std::size_t
+trim_prefix(const CharT * first, std::size_t count, const CharT * set, std::size_t set_count)
+noexcept
+{
+  if constexpr (sizeof(CharT) == 1) {
+    return byte_set_prefix(reinterpret_cast<const char *>(first), count,
+      reinterpret_cast<const char *>(set), set_count);
+  } else {
+    std::size_t i = 0;
+    while (i < count && Traits::find(set, set_count, first[i]) != nullptr) {
+      ++i;
+    }
+    return i;
+  }
+}
+
+/// Returns the number of trailing characters of [@a first, @a first + @a count) in [@a set, @a set + @a set_count).
+template<
+  typename Traits,
+  typename CharT
+>
+inline std::size_t
+trim_suffix(const CharT * first, std::size_t count, const CharT * set, std::size_t set_count)
+noexcept
+{
+  if constexpr (sizeof(CharT) == 1) {
+    return byte_set_suffix(reinterpret_cast<const char *>(first), count,
+      reinterpret_cast<const char *>(set), set_count);
+  } else {
+    std::size_t i = count;
+    while (i > 0 && Traits::find(set, set_count, first[i - 1]) != nullptr) {
+      --i;
+    }
+    return count - i;
+  }
+}
+
+/// Returns the length of the leading run of ASCII bytes in [@a first, @a first + @a count).
+inline std::size_t
+ascii_prefix(const char * first, std::size_t count)
+noexcept
+{
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= count; i += 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+    const int mask = _mm_movemask_epi8(bytes);
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+  }
+#endif
+  while (i < count && static_cast<unsigned char>(first[i]) < 0x80) {
+    ++i;
+  }
+  return i;
+}
+
+/// Checks that [@a first, @a first + @a count) is well-formed UTF-8.
+/**
+ * Rejects overlong encodings, surrogates and code points above U+10FFFF.
+ * Runs of ASCII are skipped a vector at a time.
+ */
+inline bool
+validate_utf8(const char * first, std::size_t count)
+noexcept
+{
+  const auto * s = reinterpret_cast<const unsigned char *>(first);
+  std::size_t i = 0;
+  while (i < count) {
+    i += ascii_prefix(first + i, count - i);
+    if (i == count) {
+      return true;
+    }
+    const unsigned char lead = s[i];
+    std::size_t length = 0;
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      length = 3;
+      lo = lead == 0xE0 ? 0xA0 : 0x80;
+      hi = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      length = 4;
+      lo = lead == 0xF0 ? 0x90 : 0x80;
+      hi = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+      return false;
+    }
+    if (count - i < length || s[i + 1] < lo || s[i + 1] > hi) {
+      return false;
+    }
+    for (std::size_t k = 2; k < length; ++k) {
+      if ((s[i + k] & 0xC0U) != 0x80U) {
+        return false;
+      }
+    }
+    i += length;
+  }
+  return true;
+}
+
+/// Returns true if @a ch is a UTF-8 continuation byte (10xxxxxx).
+constexpr bool
+is_utf8_continuation(char ch)
+noexcept
+{
+  return (static_cast<unsigned char>(ch) & 0xC0U) == 0x80U;
+}
+
+#if defined(__SSE2__)
+/// Returns a bit per byte of the 16 bytes at @a first, set for bytes which start a code point.
+inline unsigned
+utf8_lead_mask(const char * first)
+noexcept
+{
+  // Continuation bytes are 0x80..0xBF, i.e. -128..-65 as signed bytes
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+  return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(-65))));
+}
+#endif
+
+/// Returns the number of code points in the well-formed UTF-8 [@a first, @a first + @a count).
+/**
+ * Counts the bytes which are not continuation bytes, a vector at a time.
+ */
+inline std::size_t
+count_utf8_code_points(const char * first, std::size_t count)
+noexcept
+{
+  std::size_t code_points = 0;
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= count; i += 16) {
+    code_points += static_cast<std::size_t>(__builtin_popcount(utf8_lead_mask(first + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    code_points += is_utf8_continuation(first[i]) ? 0 : 1;
+  }
+  return code_points;
+}
+
+/// Returns the byte offset of code point @a n of the well-formed UTF-8 [@a first, @a first + @a count).
+/**
+ * That is the length of the prefix holding the first @a n code points, or
+ * @a count if there are no more than @a n.
+ */
+inline std::size_t
+utf8_code_point_offset(const char * first, std::size_t count, std::size_t n)
+noexcept
+{
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= count; i += 16) {
+    unsigned mask = utf8_lead_mask(first + i);
+    const auto leads = static_cast<std::size_t>(__builtin_popcount(mask));
+    if (leads > n) {
+      // Drop the lowest n lead bits; the next one starts code point n
+      for (; n > 0; --n) {
+        mask &= mask - 1;
+      }
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    n -= leads;
+  }
+#endif
+  for (; i < count; ++i) {
+    if (!is_utf8_continuation(first[i])) {
+      if (n == 0) {
+        return i;
+      }
+      --n;
+    }
+  }
+  return count;
+}
+
+/// Returns the longest length, at most @a max_bytes, at which [@a first, @a first + @a count) can be cut.
+/**
+ * Backs off over at most three continuation bytes, so a multi-byte sequence
+ * of well-formed UTF-8 is never split.
+ */
+inline std::size_t
+utf8_truncation_point(const char * first, std::size_t count, std::size_t max_bytes)
+noexcept
+{
+  if (count <= max_bytes) {
+    return count;
+  }
+  std::size_t i = max_bytes;
+  while (i > 0 && is_utf8_continuation(first[i])) {
+    --i;
+  }
+  return i;
+}
+
+/// Returns a 64-bit hash of the bytes [@a first, @a first + @a count).
+/**
+ * Mixes eight bytes per step with a multiply and xor-shift. Fast and
+ * well distributed for hash tables; not suitable for cryptographic use.
+ */
+inline std::uint64_t
+hash_bytes(const void * first, std::size_t count)
+noexcept
+{
+  constexpr std::uint64_t k0 = 0x9E3779B97F4A7C15ULL;
+  constexpr std::uint64_t k1 = 0xBF58476D1CE4E5B9ULL;
+  const auto * p = static_cast<const unsigned char *>(first);
+  std::uint64_t h = k0 ^ (count * k1);
+  const auto mix = [](std::uint64_t x) {
+    x ^= x >> 31U;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 29U;
+    return x;
+  };
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, p + i, 8);
+    h = mix(h ^ (word * k1)) * k0;
+  }
+  if (i < count) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, p + i, count - i);
+    h = mix(h ^ (word * k1)) * k0;
+  }
+  return mix(h);
+}
+
+}  // namespace bounded_string_detail
+
+#endif /* BOUNDED_STRING_SIMD_HPP */
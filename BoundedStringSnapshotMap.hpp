@@ -0,0 +1,291 @@
+#ifndef BOUNDED_STRING_SNAPSHOT_MAP_HPP
+#define BOUNDED_STRING_SNAPSHOT_MAP_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "InlineBoundedString.hpp"
+
+/// A read-optimised map from bounded keys to bounded values, replaced as a whole.
+/**
+ * The map is an immutable table of entries sorted by key, with keys and values
+ * stored inline next to each other. Writers build a complete new table and
+ * publish it with an atomic pointer swap; readers look keys up with a binary
+ * search on whichever table was current when they started.
+ *
+ * Old tables are reclaimed with epochs. Each reader owns a slot (see
+ * make_reader()) on its own cache line, and a read section only stores the
+ * current epoch into that slot, issues a fence and loads the table pointer:
+ * readers never take a lock or perform an atomic read-modify-write. A writer
+ * frees a retired table once no slot still announces an epoch from before the
+ * table was retired.
+ *
+ * \tparam CharT Type of character
+ * \tparam KeyBound The upper bound for the number of characters in a key
+ * \tparam ValueBound The upper bound for the number of characters in a value
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t KeyBound,
+  std::size_t ValueBound,
+  typename Traits = std::char_traits<CharT>
+>
+class bounded_string_snapshot_map
+{
+public:
+  using key_type = inline_bounded_basic_string<CharT, KeyBound, Traits>;
+  using mapped_type = inline_bounded_basic_string<CharT, ValueBound, Traits>;
+  using size_type = std::size_t;
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  /// One key/value pair of a table.
+  struct value_type
+  {
+    key_type key;
+    mapped_type value;
+  };
+
+private:
+  struct table
+  {
+    std::vector<value_type> entries;
+  };
+
+  struct alignas(bounded_string_cache_line_size) reader_slot
+  {
+    // 0 when the reader is outside a read section
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<bool> claimed{false};
+  };
+
+public:
+  class reader;
+
+  /// A read section pinning one table; the table stays alive until it is destroyed.
+  class snapshot
+  {
+  public:
+    snapshot(const snapshot &) = delete;
+    snapshot & operator=(const snapshot &) = delete;
+
+    ~snapshot() noexcept
+    {
+      slot_.epoch.store(0, std::memory_order_release);
+    }
+
+    /// Returns the value for @a key, or nullptr if it is not present.
+    const mapped_type *
+    find(view_type key) const noexcept
+    {
+      const auto & entries = table_->entries;
+      const auto it = std::lower_bound(entries.begin(), entries.end(), key,
+        [](const value_type & entry, view_type k) { return entry.key.view() < k; });
+      if (it == entries.end() || it->key.view() != key) {
+        return nullptr;
+      }
+      return &it->value;
+    }
+
+    /// Returns the number of entries in the table.
+    size_type
+    size() const noexcept
+    {
+      return table_->entries.size();
+    }
+
+    /// Iterators over the entries in key order.
+    typename std::vector<value_type>::const_iterator begin() const noexcept { return table_->entries.begin(); }
+    typename std::vector<value_type>::const_iterator end() const noexcept { return table_->entries.end(); }
+
+  private:
+    friend class reader;
+
+    snapshot(const bounded_string_snapshot_map & map, reader_slot & slot) noexcept
+    : slot_(slot)
+    {
+      slot_.epoch.store(map.epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+      // Pairs with the fence in publish(): either the writer sees our epoch
+      // or we see its new table.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      table_ = map.current_.load(std::memory_order_acquire);
+    }
+
+    reader_slot & slot_;
+    const table * table_;
+  };
+
+  /// A registered reader. Not thread-safe; give each reading thread its own.
+  class reader
+  {
+  public:
+    reader(const reader &) = delete;
+    reader & operator=(const reader &) = delete;
+
+    reader(reader && other) noexcept
+    : map_(other.map_), slot_(std::exchange(other.slot_, nullptr))
+    {}
+
+    ~reader() noexcept
+    {
+      if (slot_ != nullptr) {
+        slot_->claimed.store(false, std::memory_order_release);
+      }
+    }
+
+    /// Starts a read section on the current table.
+    /**
+     * A reader may only hold one snapshot at a time.
+     */
+    snapshot
+    read() const noexcept
+    {
+      return snapshot(*map_, *slot_);
+    }
+
+    /// Copies the value for @a key into @a out.
+    /**
+     * \return false if @a key is not present
+     */
+    bool
+    get(view_type key, mapped_type & out) const noexcept
+    {
+      const snapshot snap = read();
+      const mapped_type * value = snap.find(key);
+      if (value == nullptr) {
+        return false;
+      }
+      out.assign(value->view());
+      return true;
+    }
+
+  private:
+    friend class bounded_string_snapshot_map;
+
+    reader(const bounded_string_snapshot_map & map, reader_slot & slot) noexcept
+    : map_(&map), slot_(&slot)
+    {}
+
+    const bounded_string_snapshot_map * map_;
+    reader_slot * slot_;
+  };
+
+  /// Create an empty map which supports up to @a max_readers concurrent readers.
+  explicit
+  bounded_string_snapshot_map(size_type max_readers)
+  : slots_(std::make_unique<reader_slot[]>(max_readers)),
+    slot_count_(max_readers),
+    current_(new table())
+  {}
+
+  bounded_string_snapshot_map(const bounded_string_snapshot_map &) = delete;
+  bounded_string_snapshot_map & operator=(const bounded_string_snapshot_map &) = delete;
+
+  /// All readers must have been destroyed before the map.
+  ~bounded_string_snapshot_map() noexcept
+  {
+    delete current_.load(std::memory_order_relaxed);
+    for (auto & retired : retired_) {
+      delete retired.second;
+    }
+  }
+
+  /// Registers a reader, claiming one of the reader slots.
+  /**
+   * \throws runtime_error If all @a max_readers slots are in use
+   */
+  reader
+  make_reader()
+  {
+    for (size_type i = 0; i < slot_count_; ++i) {
+      bool expected = false;
+      if (slots_[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return reader(*this, slots_[i]);
+      }
+    }
+    throw std::runtime_error("Exceeded maximum number of readers");
+  }
+
+  /// Replaces the whole map with @a entries.
+  /**
+   * Sorts the entries by key; if a key appears more than once, the last
+   * occurrence wins. Frees any retired tables that readers have let go of.
+   * Writers are serialised with a mutex.
+   */
+  void
+  publish(std::vector<value_type> entries)
+  {
+    std::stable_sort(entries.begin(), entries.end(),
+      [](const value_type & lhs, const value_type & rhs) { return lhs.key < rhs.key; });
+    auto next = std::make_unique<table>();
+    next->entries.reserve(entries.size());
+    for (auto & entry : entries) {
+      if (!next->entries.empty() && next->entries.back().key == entry.key) {
+        next->entries.back() = entry;
+      } else {
+        next->entries.push_back(entry);
+      }
+    }
+
+    const std::lock_guard<std::mutex> lock(writer_mutex_);
+    const table * old = current_.exchange(next.release(), std::memory_order_acq_rel);
+    const std::uint64_t retired_epoch = epoch_.load(std::memory_order_relaxed);
+    epoch_.store(retired_epoch + 1, std::memory_order_release);
+    retired_.emplace_back(retired_epoch, old);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    reclaim();
+  }
+
+  /// Frees retired tables which no reader can still be using.
+  /**
+   * \return The number of retired tables still waiting for readers
+   */
+  size_type
+  collect()
+  {
+    const std::lock_guard<std::mutex> lock(writer_mutex_);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    reclaim();
+    return retired_.size();
+  }
+
+private:
+  void
+  reclaim()
+  {
+    std::uint64_t oldest = UINT64_MAX;
+    for (size_type i = 0; i < slot_count_; ++i) {
+      const std::uint64_t epoch = slots_[i].epoch.load(std::memory_order_acquire);
+      if (epoch != 0) {
+        oldest = std::min(oldest, epoch);
+      }
+    }
+    const auto unused = std::partition(retired_.begin(), retired_.end(),
+      [oldest](const auto & retired) { return retired.first >= oldest; });
+    for (auto it = unused; it != retired_.end(); ++it) {
+      delete it->second;
+    }
+    retired_.erase(unused, retired_.end());
+  }
+
+  const std::unique_ptr<reader_slot[]> slots_;
+  const size_type slot_count_;
+
+  alignas(bounded_string_cache_line_size) std::atomic<const table *> current_;
+  // Starts at 1 so that 0 can mark an idle reader slot
+  std::atomic<std::uint64_t> epoch_{1};
+
+  std::mutex writer_mutex_;
+  std::vector<std::pair<std::uint64_t, const table *>> retired_;
+};
+
+#endif /* BOUNDED_STRING_SNAPSHOT_MAP_HPP */
@@ -0,0 +1,452 @@
+#ifndef BOUNDED_STRING_TRANSCODE_HPP
+#define BOUNDED_STRING_TRANSCODE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "BoundedString.hpp"
+#include "InlineBoundedString.hpp"
+
+/// Transcoding between UTF-8, UTF-16 and UTF-32 bounded strings.
+/**
+ * The encoding is taken from the width of the character type: char (and
+ * char8_t in C++20) hold UTF-8, char16_t UTF-16 and char32_t UTF-32. The
+ * bound of the output type must hold the worst-case expansion of the bound
+ * of the input type, transcoded_bound_v, which is checked at compile time,
+ * so a conversion can never overflow. Ill-formed input is reported in the
+ * returned transcode_result rather than by an exception.
+ *
+ * Runs of characters which map one to one (ASCII, and between UTF-16 and
+ * UTF-32 anything in the Basic Multilingual Plane outside the surrogates)
+ * are converted a vector at a time; the rest is decoded and encoded one code
+ * point at a time.
+ */
+
+/// The outcome of a transcoding.
+enum class transcode_status
+{
+  ok,
+  /// The input is ill-formed: a truncated or overlong sequence, an unpaired surrogate or a value above U+10FFFF
+  invalid_input
+};
+
+/// The outcome of a transcoding and how far it got.
+struct transcode_result
+{
+  transcode_status status = transcode_status::ok;
+  /// Input units converted; on failure, the offset of the ill-formed sequence
+  std::size_t read = 0;
+  /// Output units written
+  std::size_t written = 0;
+
+  explicit operator bool() const noexcept
+  {
+    return status == transcode_status::ok;
+  }
+};
+
+namespace bounded_string_detail
+{
+
+/// The width in bytes of a UTF code unit, or 0 if @p CharT is not a UTF code unit type.
+template<
+  typename CharT
+>
+inline constexpr std::size_t utf_unit_size = 0;
+
+template<>
+inline constexpr std::size_t utf_unit_size<char> = 1;
+
+#if defined(__cpp_char8_t)
+template<>
+inline constexpr std::size_t utf_unit_size<char8_t> = 1;
+#endif
+
+template<>
+inline constexpr std::size_t utf_unit_size<char16_t> = 2;
+
+template<>
+inline constexpr std::size_t utf_unit_size<char32_t> = 4;
+
+/// The most output units one input unit can become.
+constexpr std::size_t
+transcode_expansion(std::size_t from, std::size_t to) noexcept
+{
+  // A UTF-16 unit outside a surrogate pair becomes up to three UTF-8 bytes and
+  // a UTF-32 unit up to four UTF-8 bytes or a surrogate pair; every other
+  // direction needs at most as many units as it reads.
+  return to == 1 ? (from == 2 ? 3 : 4) : (to == 2 && from == 4 ? 2 : 1);
+}
+
+}  // namespace bounded_string_detail
+
+/// The bound an output of @p ToChar needs to hold any input of @p Bound units of @p FromChar.
+template<
+  typename FromChar,
+  typename ToChar,
+  std::size_t Bound
+>
+inline constexpr std::size_t transcoded_bound_v = Bound * bounded_string_detail::transcode_expansion(
+  bounded_string_detail::utf_unit_size<FromChar>, bounded_string_detail::utf_unit_size<ToChar>);
+
+/// The bounded_basic_string of @p ToChar which any bounded_basic_string<FromChar, Bound> transcodes into.
+template<
+  typename ToChar,
+  typename FromChar,
+  std::size_t Bound
+>
+using transcoded_bounded_string = bounded_basic_string<ToChar, transcoded_bound_v<FromChar, ToChar, Bound>>;
+
+namespace bounded_string_detail
+{
+
+/// Decodes the code point at @a s into @a cp.
+/**
+ * \return The number of units it takes, or 0 if it is ill-formed
+ */
+template<
+  typename CharT
+>
+inline std::size_t
+decode_utf(const CharT * s, std::size_t count, char32_t & cp)
+noexcept
+{
+  if constexpr (utf_unit_size<CharT> == 1) {
+    const auto lead = static_cast<unsigned char>(s[0]);
+    if (lead < 0x80) {
+      cp = lead;
+      return 1;
+    }
+    std::size_t length = 0;
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+    char32_t value = 0;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      length = 2;
+      value = lead & 0x1FU;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      length = 3;
+      value = lead & 0x0FU;
+      lo = lead == 0xE0 ? 0xA0 : 0x80;
+      hi = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      length = 4;
+      value = lead & 0x07U;
+      lo = lead == 0xF0 ? 0x90 : 0x80;
+      hi = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+      return 0;
+    }
+    if (count < length) {
+      return 0;
+    }
+    for (std::size_t k = 1; k < length; ++k) {
+      const auto byte = static_cast<unsigned char>(s[k]);
+      if (byte < (k == 1 ? lo : 0x80) || byte > (k == 1 ? hi : 0xBF)) {
+        return 0;
+      }
+      value = (value << 6U) | (byte & 0x3FU);
+    }
+    cp = value;
+    return length;
+  } else if constexpr (utf_unit_size<CharT> == 2) {
+    const char32_t unit = s[0];
+    if (unit < 0xD800 || unit > 0xDFFF) {
+      cp = unit;
+      return 1;
+    }
+    if (unit > 0xDBFF || count < 2 || s[1] < 0xDC00 || s[1] > 0xDFFF) {
+      return 0;
+    }
+    cp = 0x10000 + ((unit - 0xD800) << 10U) + (s[1] - 0xDC00);
+    return 2;
+  } else {
+    const char32_t unit = s[0];
+    if (unit > 0x10FFFF || (unit >= 0xD800 && unit <= 0xDFFF)) {
+      return 0;
+    }
+    cp = unit;
+    return 1;
+  }
+}
+
+/// Encodes the valid code point @a cp at @a out and returns the number of units written.
+template<
+  typename CharT
+>
+inline std::size_t
+encode_utf(char32_t cp, CharT * out)
+noexcept
+{
+  if constexpr (utf_unit_size<CharT> == 1) {
+    if (cp < 0x80) {
+      out[0] = static_cast<CharT>(cp);
+      return 1;
+    }
+    if (cp < 0x800) {
+      out[0] = static_cast<CharT>(0xC0 | (cp >> 6U));
+      out[1] = static_cast<CharT>(0x80 | (cp & 0x3FU));
+      return 2;
+    }
+    if (cp < 0x10000) {
+      out[0] = static_cast<CharT>(0xE0 | (cp >> 12U));
+      out[1] = static_cast<CharT>(0x80 | ((cp >> 6U) & 0x3FU));
+      out[2] = static_cast<CharT>(0x80 | (cp & 0x3FU));
+      return 3;
+    }
+    out[0] = static_cast<CharT>(0xF0 | (cp >> 18U));
+    out[1] = static_cast<CharT>(0x80 | ((cp >> 12U) & 0x3FU));
+    out[2] = static_cast<CharT>(0x80 | ((cp >> 6U) & 0x3FU));
+    out[3] = static_cast<CharT>(0x80 | (cp & 0x3FU));
+    return 4;
+  } else if constexpr (utf_unit_size<CharT> == 2) {
+    if (cp < 0x10000) {
+      out[0] = static_cast<CharT>(cp);
+      return 1;
+    }
+    out[0] = static_cast<CharT>(0xD800 + ((cp - 0x10000) >> 10U));
+    out[1] = static_cast<CharT>(0xDC00 + (cp & 0x3FFU));
+    return 2;
+  } else {
+    out[0] = static_cast<CharT>(cp);
+    return 1;
+  }
+}
+
+/// Converts the leading run of units of [@a in, @a in + @a count) which map one to one, a vector at a time.
+/**
+ * Stops at the first vector which holds any other unit, so the run it
+ * returns the length of may be shorter than the actual one.
+ */
+template<
+  typename From,
+  typename To
+>
+inline std::size_t
+transcode_direct_run(const From * in, std::size_t count, To * out)
+noexcept
+{
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  constexpr std::size_t from = utf_unit_size<From>;
+  constexpr std::size_t to = utf_unit_size<To>;
+  const auto load = [in](std::size_t k) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + k));
+  };
+  const auto store = [out](std::size_t k, __m128i v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), v);
+  };
+  const __m128i zero = _mm_setzero_si128();
+  if constexpr (from == 1) {
+    // 16 ASCII bytes, widened with zeros
+    for (; i + 16 <= count; i += 16) {
+      const __m128i bytes = load(i);
+      if (_mm_movemask_epi8(bytes) != 0) {
+        break;
+      }
+      const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+      const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+      if constexpr (to == 2) {
+        store(i, lo);
+        store(i + 8, hi);
+      } else {
+        store(i, _mm_unpacklo_epi16(lo, zero));
+        store(i + 4, _mm_unpackhi_epi16(lo, zero));
+        store(i + 8, _mm_unpacklo_epi16(hi, zero));
+        store(i + 12, _mm_unpackhi_epi16(hi, zero));
+      }
+    }
+  } else if constexpr (from == 2 && to == 1) {
+    // 16 ASCII units, narrowed; packus saturates, so test the high bits first
+    const __m128i high = _mm_set1_epi16(static_cast<short>(0xFF80));
+    for (; i + 16 <= count; i += 16) {
+      const __m128i a = load(i);
+      const __m128i b = load(i + 8);
+      const __m128i non_ascii = _mm_and_si128(_mm_or_si128(a, b), high);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(non_ascii, zero)) != 0xFFFF) {
+        break;
+      }
+      store(i, _mm_packus_epi16(a, b));
+    }
+  } else if constexpr (from == 2) {
+    // 8 units none of which is a surrogate, widened with zeros
+    const __m128i mask = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+    for (; i + 8 <= count; i += 8) {
+      const __m128i units = load(i);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, mask), surrogate)) != 0) {
+        break;
+      }
+      store(i, _mm_unpacklo_epi16(units, zero));
+      store(i + 4, _mm_unpackhi_epi16(units, zero));
+    }
+  } else if constexpr (to == 1) {
+    // 16 ASCII code points, narrowed in two saturating packs
+    const __m128i high = _mm_set1_epi32(static_cast<int>(0xFFFFFF80U));
+    for (; i + 16 <= count; i += 16) {
+      const __m128i a = load(i);
+      const __m128i b = load(i + 4);
+      const __m128i c = load(i + 8);
+      const __m128i d = load(i + 12);
+      const __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(all, high), zero)) != 0xFFFF) {
+        break;
+      }
+      store(i, _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+    }
+  } else {
+    // 8 code points in the BMP and outside the surrogates, narrowed; the
+    // bias makes the signed saturating pack exact for 0..0xFFFF
+    const __m128i upper = _mm_set1_epi32(static_cast<int>(0xFFFF0000U));
+    const __m128i mask = _mm_set1_epi32(0xF800);
+    const __m128i surrogate = _mm_set1_epi32(0xD800);
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const auto direct = [&](__m128i units) {
+      const __m128i bmp = _mm_cmpeq_epi32(_mm_and_si128(units, upper), zero);
+      const __m128i in_surrogates = _mm_cmpeq_epi32(_mm_and_si128(units, mask), surrogate);
+      return _mm_movemask_epi8(_mm_andnot_si128(in_surrogates, bmp)) == 0xFFFF;
+    };
+    for (; i + 8 <= count; i += 8) {
+      const __m128i a = load(i);
+      const __m128i b = load(i + 4);
+      if (!direct(a) || !direct(b)) {
+        break;
+      }
+      const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+      store(i, _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000))));
+    }
+  }
+#else
+  (void)in;
+  (void)count;
+  (void)out;
+#endif
+  return i;
+}
+
+}  // namespace bounded_string_detail
+
+/// Transcodes [@a in, @a in + @a count) into @a out, which must have room for the worst case.
+/**
+ * \param in The input units
+ * \param count The number of input units
+ * \param out Room for count * transcoded_bound_v<From, To, 1> output units
+ * \return The status and the units read and written; on failure the output
+ *   holds the conversion of the input before the ill-formed sequence
+ */
+template<
+  typename From,
+  typename To
+>
+inline transcode_result
+transcode_utf(const From * in, std::size_t count, To * out)
+noexcept
+{
+  static_assert(bounded_string_detail::utf_unit_size<From> != 0 && bounded_string_detail::utf_unit_size<To> != 0,
+    "Both character types must be UTF code unit types");
+  static_assert(bounded_string_detail::utf_unit_size<From> != bounded_string_detail::utf_unit_size<To>,
+    "Input and output must use different encodings");
+  std::size_t i = 0;
+  std::size_t o = 0;
+  while (i < count) {
+    const std::size_t run = bounded_string_detail::transcode_direct_run(in + i, count - i, out + o);
+    i += run;
+    o += run;
+    if (i == count) {
+      break;
+    }
+    char32_t cp = 0;
+    const std::size_t used = bounded_string_detail::decode_utf(in + i, count - i, cp);
+    if (used == 0) {
+      return {transcode_status::invalid_input, i, o};
+    }
+    i += used;
+    o += bounded_string_detail::encode_utf(cp, out + o);
+  }
+  return {transcode_status::ok, i, o};
+}
+
+namespace bounded_string_detail
+{
+
+/// Transcodes into a string with room for the worst case, which is shrunk to the result.
+template<
+  typename String,
+  typename From
+>
+inline transcode_result
+transcode_into(const From * in, std::size_t count, String & out)
+{
+  using To = typename String::value_type;
+  // Filling costs one pass over the output; neither string type can grow
+  // without writing its characters
+  out.assign(count * transcode_expansion(utf_unit_size<From>, utf_unit_size<To>), To());
+  const transcode_result result = transcode_utf(in, count, out.data());
+  out.erase(result.written);
+  return result;
+}
+
+}  // namespace bounded_string_detail
+
+/// Transcodes @a in into @a out, replacing its contents.
+/**
+ * \param in The string to convert
+ * \param out The string to hold the result; its bound must be at least
+ *   transcoded_bound_v<FromChar, ToChar, FromBound>
+ * \return The status and the units read and written; on failure @a out holds
+ *   the conversion of the input before the ill-formed sequence
+ * \throws bad_alloc Only if @a out must allocate; ill-formed input does not throw
+ */
+template<
+  typename ToChar,
+  std::size_t ToBound,
+  typename ToTraits,
+  typename ToAllocator,
+  typename FromChar,
+  std::size_t FromBound,
+  typename FromTraits,
+  typename FromAllocator
+>
+inline transcode_result
+transcode_utf(
+  const bounded_basic_string<FromChar, FromBound, FromTraits, FromAllocator> & in,
+  bounded_basic_string<ToChar, ToBound, ToTraits, ToAllocator> & out)
+{
+  static_assert(ToBound >= transcoded_bound_v<FromChar, ToChar, FromBound>,
+    "The output bound must hold the worst-case expansion of the input bound");
+  return bounded_string_detail::transcode_into(in.data(), in.size(), out);
+}
+
+/// Transcodes @a in into @a out, replacing its contents; never allocates or throws.
+/**
+ * \param in The string to convert
+ * \param out The string to hold the result; its bound must be at least
+ *   transcoded_bound_v<FromChar, ToChar, FromBound>
+ * \return The status and the units read and written; on failure @a out holds
+ *   the conversion of the input before the ill-formed sequence
+ */
+template<
+  typename ToChar,
+  std::size_t ToBound,
+  typename ToTraits,
+  typename FromChar,
+  std::size_t FromBound,
+  typename FromTraits
+>
+inline transcode_result
+transcode_utf(
+  const inline_bounded_basic_string<FromChar, FromBound, FromTraits> & in,
+  inline_bounded_basic_string<ToChar, ToBound, ToTraits> & out)
+noexcept
+{
+  static_assert(ToBound >= transcoded_bound_v<FromChar, ToChar, FromBound>,
+    "The output bound must hold the worst-case expansion of the input bound");
+  return bounded_string_detail::transcode_into(in.data(), in.size(), out);
+}
+
+#endif /* BOUNDED_STRING_TRANSCODE_HPP */
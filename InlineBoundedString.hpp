@@ -0,0 +1,747 @@
+#ifndef INLINE_BOUNDED_STRING_HPP
+#define INLINE_BOUNDED_STRING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "BoundedStringError.hpp"
+#include "BoundedStringSimd.hpp"
+
+/// Size of a cache line, used to keep independently written state apart.
+inline constexpr std::size_t bounded_string_cache_line_size = 64;
+
+/// A bounded string which keeps its characters inline in a fixed-size buffer.
+/**
+ * Unlike bounded_basic_string, which is backed by std::basic_string and may
+ * allocate, this class never allocates and holds no pointers. It is trivially
+ * copyable and standard-layout, so objects can be copied with memcpy and placed
+ * in buffers shared between threads or processes.
+ * Only compiles if UpperBound is a positive integral value.
+ *
+ * \tparam CharT Type of character
+ * \tparam UpperBound The upper bound for the number of characters
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits = std::char_traits<CharT>,
+  typename = std::enable_if_t<(UpperBound > 0)>
+>
+class inline_bounded_basic_string
+{
+public:
+  using traits_type = Traits;
+  using value_type = CharT;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using pointer = value_type *;
+  using const_pointer = const value_type *;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  // Constructors
+  /// Create an empty %inline_bounded_basic_string object.
+  inline_bounded_basic_string()
+  noexcept
+  : size_(0)
+  {
+    static_assert(offsetof(inline_bounded_basic_string, data_) == sizeof(size_type),
+      "used_bytes() assumes the characters directly follow the size");
+    data_[0] = CharT();
+  }
+
+  /// Create an %inline_bounded_basic_string object with @a count copies of @a ch.
+  /**
+   * \param count The number of characters initially contained in the string
+   * \param ch The character to populate the string with
+   * \throws length_error If @a count > @p UpperBound
+   */
+  inline_bounded_basic_string(
+    size_type count,
+    CharT ch)
+  : inline_bounded_basic_string()
+  {
+    assign(count, ch);
+  }
+
+  /// Create an %inline_bounded_basic_string with the first count characters of a pointed string.
+  /**
+   * \param s The character buffer to copy from
+   * \param count The number of characters to copy
+   * \throws length_error If @a count > @p UpperBound
+   */
+  inline_bounded_basic_string(
+    const CharT * s,
+    size_type count)
+  : inline_bounded_basic_string()
+  {
+    assign(s, count);
+  }
+
+  /// Create an %inline_bounded_basic_string from a null-terminated character string.
+  /**
+   * \param s Pointer to a null-terminated character string
+   * \throws length_error If the string pointed to by @a s is longer than @p UpperBound
+   */
+  inline_bounded_basic_string(
+    const CharT * s)
+  : inline_bounded_basic_string()
+  {
+    assign(s);
+  }
+
+  /// Create an %inline_bounded_basic_string from a string view.
+  /**
+   * \param sv The string view to copy from
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  explicit
+  inline_bounded_basic_string(
+    view_type sv)
+  : inline_bounded_basic_string()
+  {
+    assign(sv);
+  }
+
+  /// Create an %inline_bounded_basic_string from an initializer list.
+  /**
+   * \param ilist The initializer to construct from
+   * \throws length_error If @a ilist is longer than @p UpperBound
+   */
+  inline_bounded_basic_string(
+    std::initializer_list<CharT> ilist)
+  : inline_bounded_basic_string()
+  {
+    assign(ilist);
+  }
+
+  /// %inline_bounded_basic_string cannot be constructed from nullptr.
+  inline_bounded_basic_string(std::nullptr_t) = delete;
+
+  // Assignment
+  /// Replace the contents with those of a null-terminated character string.
+  inline_bounded_basic_string &
+  operator=(const CharT * s)
+  {
+    return assign(s);
+  }
+
+  /// Replace the contents with those of a string view.
+  inline_bounded_basic_string &
+  operator=(view_type sv)
+  {
+    return assign(sv);
+  }
+
+  /// Replace the contents with a single character.
+  inline_bounded_basic_string &
+  operator=(CharT ch)
+  noexcept
+  {
+    // No length check required since UpperBound > 0
+    data_[0] = ch;
+    set_size(1);
+    return *this;
+  }
+
+  /// Replace string with copies of a character.
+  /**
+   * \param count Number of copies of the character
+   * \param ch The character to be copied
+   * \return L-value reference to *this
+   * \throws length_error If @a count > @p UpperBound
+   */
+  inline_bounded_basic_string &
+  assign(size_type count, CharT ch)
+  {
+    if (count > UpperBound) {
+      bounded_string_detail::throw_length_error();
+    }
+    Traits::assign(data_, count, ch);
+    set_size(count);
+    return *this;
+  }
+
+  /// Replaces with copies of a subset of characters from a character string.
+  /**
+   * \param s The character buffer to copy from
+   * \param count The number of characters to copy
+   * \return L-value reference to *this
+   * \throws length_error If @a count > @p UpperBound
+   */
+  inline_bounded_basic_string &
+  assign(const CharT * s, size_type count)
+  {
+    if (count > UpperBound) {
+      bounded_string_detail::throw_length_error();
+    }
+    // The source may alias our own buffer
+    Traits::move(data_, s, count);
+    set_size(count);
+    return *this;
+  }
+
+  /// Replace string with a null-terminated character string.
+  inline_bounded_basic_string &
+  assign(const CharT * s)
+  {
+    return assign(s, Traits::length(s));
+  }
+
+  /// Replace string with the contents of a string view.
+  inline_bounded_basic_string &
+  assign(view_type sv)
+  {
+    return assign(sv.data(), sv.size());
+  }
+
+  /// Replace string with contents of an initializer list.
+  inline_bounded_basic_string &
+  assign(std::initializer_list<CharT> ilist)
+  {
+    return assign(ilist.begin(), ilist.size());
+  }
+
+  // Capacity
+  /// Returns the number of characters in the string.
+  size_type
+  size() const noexcept
+  {
+    return size_;
+  }
+
+  /// Returns the number of characters in the string.
+  size_type
+  length() const noexcept
+  {
+    return size_;
+  }
+
+  /// Checks whether the string is empty.
+  bool
+  empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  /// Returns the number of characters the inline buffer can hold, i.e. @p UpperBound.
+  static constexpr size_type
+  capacity() noexcept
+  {
+    return UpperBound;
+  }
+
+  /// Returns the size of the largest possible %inline_bounded_basic_string.
+  static constexpr size_type
+  max_size() noexcept
+  {
+    return UpperBound;
+  }
+
+  /// Returns the number of object bytes in use by a string of @a count characters.
+  /**
+   * Everything past this many bytes from the start of the object is unused
+   * buffer space, which lets copies of short strings skip the tail.
+   */
+  static constexpr size_type
+  used_bytes(size_type count) noexcept
+  {
+    return sizeof(size_type) + (std::min(count, UpperBound) + 1) * sizeof(CharT);
+  }
+
+  // Element access
+  /// Access the character at @a pos with bounds checking.
+  /**
+   * \throws out_of_range If @a pos >= size()
+   */
+  reference
+  at(size_type pos)
+  {
+    if (pos >= size_) {
+      bounded_string_detail::throw_out_of_range();
+    }
+    return data_[pos];
+  }
+
+  /// Access the character at @a pos with bounds checking.
+  /**
+   * \throws out_of_range If @a pos >= size()
+   */
+  const_reference
+  at(size_type pos) const
+  {
+    if (pos >= size_) {
+      bounded_string_detail::throw_out_of_range();
+    }
+    return data_[pos];
+  }
+
+  reference operator[](size_type pos) noexcept { return data_[pos]; }
+  const_reference operator[](size_type pos) const noexcept { return data_[pos]; }
+  reference front() noexcept { return data_[0]; }
+  const_reference front() const noexcept { return data_[0]; }
+  reference back() noexcept { return data_[size_ - 1]; }
+  const_reference back() const noexcept { return data_[size_ - 1]; }
+  pointer data() noexcept { return data_; }
+  const_pointer data() const noexcept { return data_; }
+  const_pointer c_str() const noexcept { return data_; }
+
+  /// Returns a view of the characters in the string.
+  view_type
+  view() const noexcept
+  {
+    return view_type(data_, size_);
+  }
+
+  operator view_type() const noexcept
+  {
+    return view();
+  }
+
+  // Iterators
+  iterator begin() noexcept { return data_; }
+  const_iterator begin() const noexcept { return data_; }
+  const_iterator cbegin() const noexcept { return data_; }
+  iterator end() noexcept { return data_ + size_; }
+  const_iterator end() const noexcept { return data_ + size_; }
+  const_iterator cend() const noexcept { return data_ + size_; }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+  // Operations
+  /// Removes all characters from the string.
+  void
+  clear()
+  noexcept
+  {
+    set_size(0);
+  }
+
+  /// Appends the character @a ch to the end of the string.
+  /**
+   * \throws length_error If the string is already @p UpperBound characters long
+   */
+  void
+  push_back(CharT ch)
+  {
+    if (size_ >= UpperBound) {
+      bounded_string_detail::throw_length_error();
+    }
+    data_[size_] = ch;
+    set_size(size_ + 1);
+  }
+
+  /// Removes the last character from the string.
+  void
+  pop_back()
+  noexcept
+  {
+    set_size(size_ - 1);
+  }
+
+  /// Appends @a count copies of @a ch.
+  /**
+   * \throws length_error If the result would be longer than @p UpperBound
+   */
+  inline_bounded_basic_string &
+  append(size_type count, CharT ch)
+  {
+    if (count > UpperBound - size_) {
+      bounded_string_detail::throw_length_error();
+    }
+    Traits::assign(data_ + size_, count, ch);
+    set_size(size_ + count);
+    return *this;
+  }
+
+  /// Appends the characters in the range [@a s, @a s + @a count).
+  /**
+   * \throws length_error If the result would be longer than @p UpperBound
+   */
+  inline_bounded_basic_string &
+  append(const CharT * s, size_type count)
+  {
+    if (count > UpperBound - size_) {
+      bounded_string_detail::throw_length_error();
+    }
+    Traits::move(data_ + size_, s, count);
+    set_size(size_ + count);
+    return *this;
+  }
+
+  /// Appends a null-terminated character string.
+  inline_bounded_basic_string &
+  append(const CharT * s)
+  {
+    return append(s, Traits::length(s));
+  }
+
+  /// Appends the contents of a string view.
+  inline_bounded_basic_string &
+  append(view_type sv)
+  {
+    return append(sv.data(), sv.size());
+  }
+
+  inline_bounded_basic_string & operator+=(CharT ch) { push_back(ch); return *this; }
+  inline_bounded_basic_string & operator+=(const CharT * s) { return append(s); }
+  inline_bounded_basic_string & operator+=(view_type sv) { return append(sv); }
+
+  /// Inserts @a count copies of @a ch at position @a index.
+  /**
+   * \throws out_of_range If @a index > size()
+   * \throws length_error If the result would be longer than @p UpperBound
+   */
+  inline_bounded_basic_string &
+  insert(size_type index, size_type count, CharT ch)
+  {
+    make_gap(index, count);
+    Traits::assign(data_ + index, count, ch);
+    return *this;
+  }
+
+  /// Inserts the characters in the range [@a s, @a s + @a count) at position @a index.
+  /**
+   * \throws out_of_range If @a index > size()
+   * \throws length_error If the result would be longer than @p UpperBound
+   */
+  inline_bounded_basic_string &
+  insert(size_type index, const CharT * s, size_type count)
+  {
+    // Copy out first in case s points into our own buffer
+    const inline_bounded_basic_string src(s, std::min(count, UpperBound));
+    make_gap(index, count);
+    Traits::copy(data_ + index, src.data_, count);
+    return *this;
+  }
+
+  /// Inserts a null-terminated character string at position @a index.
+  inline_bounded_basic_string &
+  insert(size_type index, const CharT * s)
+  {
+    return insert(index, s, Traits::length(s));
+  }
+
+  /// Inserts the contents of a string view at position @a index.
+  inline_bounded_basic_string &
+  insert(size_type index, view_type sv)
+  {
+    return insert(index, sv.data(), sv.size());
+  }
+
+  /// Removes min(@a count, size() - @a index) characters starting at @a index.
+  /**
+   * \throws out_of_range If @a index > size()
+   */
+  inline_bounded_basic_string &
+  erase(size_type index = 0, size_type count = npos)
+  {
+    if (index > size_) {
+      bounded_string_detail::throw_out_of_range();
+    }
+    count = std::min(count, size_ - index);
+    if (count != 0) {
+      // Only the characters after the erased ones move
+      Traits::move(data_ + index, data_ + index + count, size_ - index - count);
+      set_size(size_ - count);
+    }
+    return *this;
+  }
+
+  /// Resizes the string to @a count characters, padding with @a ch.
+  /**
+   * \throws length_error If @a count > @p UpperBound
+   */
+  void
+  resize(size_type count, CharT ch = CharT())
+  {
+    if (count > UpperBound) {
+      bounded_string_detail::throw_length_error();
+    }
+    if (count > size_) {
+      Traits::assign(data_ + size_, count - size_, ch);
+    }
+    set_size(count);
+  }
+
+  /// Exchanges the contents of two strings.
+  void
+  swap(inline_bounded_basic_string & other)
+  noexcept
+  {
+    std::swap(*this, other);
+  }
+
+  /// Returns the substring [@a pos, @a pos + @a count).
+  /**
+   * \throws out_of_range If @a pos > size()
+   */
+  inline_bounded_basic_string
+  substr(size_type pos = 0, size_type count = npos) const
+  {
+    return inline_bounded_basic_string(view().substr(pos, count));
+  }
+
+  /// Copies the substring [@a pos, @a pos + @a count) to @a dest.
+  size_type
+  copy(CharT * dest, size_type count, size_type pos = 0) const
+  {
+    return view().copy(dest, count, pos);
+  }
+
+  /// Compares the string with a string view.
+  int
+  compare(view_type sv) const noexcept
+  {
+    return view().compare(sv);
+  }
+
+  /// Converts ASCII upper case letters to lower case; all other characters are left alone.
+  /**
+   * The length does not change, so there is no bound check. Requires a
+   * single-byte character type; bytes of multi-byte UTF-8 sequences are
+   * never changed.
+   */
+  void
+  to_lower()
+  noexcept
+  {
+    static_assert(sizeof(CharT) == 1, "ASCII case conversion needs a single-byte character type");
+    // The clamp is a no-op which shows the compiler the kernel stays inside data_
+    bounded_string_detail::ascii_to_lower(reinterpret_cast<char *>(data_), std::min(size_, UpperBound));
+  }
+
+  /// Converts ASCII lower case letters to upper case; all other characters are left alone.
+  void
+  to_upper()
+  noexcept
+  {
+    static_assert(sizeof(CharT) == 1, "ASCII case conversion needs a single-byte character type");
+    bounded_string_detail::ascii_to_upper(reinterpret_cast<char *>(data_), std::min(size_, UpperBound));
+  }
+
+  /// Folds ASCII letters to one case for caseless comparison.
+  /**
+   * Two strings which differ only in the case of ASCII letters are equal
+   * after folding. Folding maps to lower case, as Unicode simple case
+   * folding does for ASCII; non-ASCII characters are not folded.
+   */
+  void
+  casefold_ascii()
+  noexcept
+  {
+    to_lower();
+  }
+
+  /// Removes leading and trailing whitespace (" \t\n\v\f\r").
+  /**
+   * Both ends are scanned a vector at a time for single-byte characters, and
+   * the characters kept are moved at most once.
+   */
+  void
+  trim()
+  noexcept
+  {
+    rtrim();
+    ltrim();
+  }
+
+  /// Removes leading whitespace.
+  void
+  ltrim()
+  noexcept
+  {
+    erase_front(bounded_string_detail::trim_prefix(data_, size_));
+  }
+
+  /// Removes trailing whitespace.
+  void
+  rtrim()
+  noexcept
+  {
+    erase_back(bounded_string_detail::trim_suffix(data_, size_));
+  }
+
+  /// Removes leading and trailing characters which appear in @a chars.
+  void
+  trim(view_type chars)
+  noexcept
+  {
+    rtrim(chars);
+    ltrim(chars);
+  }
+
+  /// Removes leading characters which appear in @a chars.
+  void
+  ltrim(view_type chars)
+  noexcept
+  {
+    erase_front(bounded_string_detail::trim_prefix<Traits>(data_, size_, chars.data(), chars.size()));
+  }
+
+  /// Removes trailing characters which appear in @a chars.
+  void
+  rtrim(view_type chars)
+  noexcept
+  {
+    erase_back(bounded_string_detail::trim_suffix<Traits>(data_, size_, chars.data(), chars.size()));
+  }
+
+  /// Returns a view of the string without leading and trailing whitespace; nothing is copied.
+  view_type
+  trimmed_view() const
+  noexcept
+  {
+    const size_type front = bounded_string_detail::trim_prefix(data_, size_);
+    const size_type count = size_ - front;
+    return view_type(data_ + front, count - bounded_string_detail::trim_suffix(data_ + front, count));
+  }
+
+  /// Returns a view of the string without leading and trailing characters which appear in @a chars.
+  view_type
+  trimmed_view(view_type chars) const
+  noexcept
+  {
+    const size_type front = bounded_string_detail::trim_prefix<Traits>(data_, size_, chars.data(), chars.size());
+    const size_type count = size_ - front;
+    return view_type(data_ + front,
+      count - bounded_string_detail::trim_suffix<Traits>(data_ + front, count, chars.data(), chars.size()));
+  }
+
+  // Search
+  size_type find(view_type sv, size_type pos = 0) const noexcept { return view().find(sv, pos); }
+  size_type find(CharT ch, size_type pos = 0) const noexcept { return view().find(ch, pos); }
+  size_type rfind(view_type sv, size_type pos = npos) const noexcept { return view().rfind(sv, pos); }
+  size_type rfind(CharT ch, size_type pos = npos) const noexcept { return view().rfind(ch, pos); }
+  size_type find_first_of(view_type sv, size_type pos = 0) const noexcept { return view().find_first_of(sv, pos); }
+  size_type find_first_not_of(view_type sv, size_type pos = 0) const noexcept { return view().find_first_not_of(sv, pos); }
+  size_type find_last_of(view_type sv, size_type pos = npos) const noexcept { return view().find_last_of(sv, pos); }
+  size_type find_last_not_of(view_type sv, size_type pos = npos) const noexcept { return view().find_last_not_of(sv, pos); }
+
+  // Comparison
+  friend bool operator==(const inline_bounded_basic_string & lhs, const inline_bounded_basic_string & rhs) noexcept { return lhs.view() == rhs.view(); }
+  friend bool operator==(const inline_bounded_basic_string & lhs, view_type rhs) noexcept { return lhs.view() == rhs; }
+  friend bool operator==(view_type lhs, const inline_bounded_basic_string & rhs) noexcept { return lhs == rhs.view(); }
+  friend bool operator!=(const inline_bounded_basic_string & lhs, const inline_bounded_basic_string & rhs) noexcept { return lhs.view() != rhs.view(); }
+  friend bool operator!=(const inline_bounded_basic_string & lhs, view_type rhs) noexcept { return lhs.view() != rhs; }
+  friend bool operator!=(view_type lhs, const inline_bounded_basic_string & rhs) noexcept { return lhs != rhs.view(); }
+  friend bool operator<(const inline_bounded_basic_string & lhs, const inline_bounded_basic_string & rhs) noexcept { return lhs.view() < rhs.view(); }
+  friend bool operator<=(const inline_bounded_basic_string & lhs, const inline_bounded_basic_string & rhs) noexcept { return lhs.view() <= rhs.view(); }
+  friend bool operator>(const inline_bounded_basic_string & lhs, const inline_bounded_basic_string & rhs) noexcept { return lhs.view() > rhs.view(); }
+  friend bool operator>=(const inline_bounded_basic_string & lhs, const inline_bounded_basic_string & rhs) noexcept { return lhs.view() >= rhs.view(); }
+
+private:
+  void
+  set_size(size_type count)
+  noexcept
+  {
+    size_ = count;
+    data_[count] = CharT();
+  }
+
+  /// Removes the first @a count characters, moving the rest only if there is anything to remove.
+  void
+  erase_front(size_type count)
+  noexcept
+  {
+    if (count != 0) {
+      Traits::move(data_, data_ + count, size_ - count);
+      set_size(size_ - count);
+    }
+  }
+
+  /// Removes the last @a count characters.
+  void
+  erase_back(size_type count)
+  noexcept
+  {
+    set_size(size_ - count);
+  }
+
+  /// Opens a gap of @a count characters at @a index, growing the string.
+  void
+  make_gap(size_type index, size_type count)
+  {
+    if (index > size_) {
+      bounded_string_detail::throw_out_of_range();
+    }
+    if (count > UpperBound - size_) {
+      bounded_string_detail::throw_length_error();
+    }
+    Traits::move(data_ + index + count, data_ + index, size_ - index);
+    set_size(size_ + count);
+  }
+
+  // size_ comes first so that used_bytes() can describe a prefix of the object
+  size_type size_;
+  CharT data_[UpperBound + 1];
+};
+
+/// An %inline_bounded_basic_string of char.
+template<
+  std::size_t UpperBound
+>
+using inline_bounded_string = inline_bounded_basic_string<char, UpperBound>;
+
+/// Returns a copy of @a s with ASCII upper case letters converted to lower case.
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits
+>
+inline_bounded_basic_string<CharT, UpperBound, Traits>
+to_lower(inline_bounded_basic_string<CharT, UpperBound, Traits> s)
+noexcept
+{
+  s.to_lower();
+  return s;
+}
+
+/// Returns a copy of @a s with ASCII lower case letters converted to upper case.
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits
+>
+inline_bounded_basic_string<CharT, UpperBound, Traits>
+to_upper(inline_bounded_basic_string<CharT, UpperBound, Traits> s)
+noexcept
+{
+  s.to_upper();
+  return s;
+}
+
+/// Returns a copy of @a s with ASCII letters folded for caseless comparison.
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits
+>
+inline_bounded_basic_string<CharT, UpperBound, Traits>
+casefold_ascii(inline_bounded_basic_string<CharT, UpperBound, Traits> s)
+noexcept
+{
+  s.casefold_ascii();
+  return s;
+}
+
+#endif /* INLINE_BOUNDED_STRING_HPP */
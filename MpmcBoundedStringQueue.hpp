@@ -0,0 +1,389 @@
+#ifndef MPMC_BOUNDED_STRING_QUEUE_HPP
+#define MPMC_BOUNDED_STRING_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "BoundedStringError.hpp"
+#include "InlineBoundedString.hpp"
+
+namespace bounded_string_detail
+{
+
+/// Blocks while @a word still holds @a expected, or until woken.
+inline void
+futex_wait(std::atomic<std::uint32_t> & word, std::uint32_t expected)
+noexcept
+{
+#if defined(__linux__)
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+    "futex word must be a plain 32-bit integer");
+  (void)syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word),
+    FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+  while (word.load(std::memory_order_acquire) == expected) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+/// Wakes up to @a count threads blocked in futex_wait on @a word.
+inline void
+futex_wake(std::atomic<std::uint32_t> & word, int count)
+noexcept
+{
+#if defined(__linux__)
+  (void)syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word),
+    FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+  (void)word;
+  (void)count;
+#endif
+}
+
+}  // namespace bounded_string_detail
+
+/// A bounded multi-producer, multi-consumer queue of inline bounded strings.
+/**
+ * Uses Dmitry Vyukov's array queue: every cache-line-aligned cell carries a
+ * sequence number which tells producers and consumers whose turn it is, so a
+ * push or pop costs one CAS on a shared index. Messages are
+ * %inline_bounded_basic_string objects constructed and read in place.
+ *
+ * Each operation comes in three flavours:
+ * - try_*: return false immediately if the queue is full (or empty);
+ * - spin_*: retry until they succeed, yielding between attempts;
+ * - push, emplace, pop, consume: block on a futex until they can proceed.
+ *   Futex words are only touched when a thread is actually blocked.
+ *
+ * \tparam CharT Type of character
+ * \tparam UpperBound The upper bound for the number of characters in a message
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits = std::char_traits<CharT>
+>
+class mpmc_bounded_string_queue
+{
+public:
+  using value_type = inline_bounded_basic_string<CharT, UpperBound, Traits>;
+  using size_type = std::size_t;
+  using view_type = typename value_type::view_type;
+
+  /// Create a queue holding at least @a capacity messages.
+  /**
+   * \param capacity The minimum number of cells; rounded up to a power of two
+   * \throws length_error If @a capacity is less than two or has no power of two above it
+   */
+  explicit
+  mpmc_bounded_string_queue(size_type capacity)
+  : mask_(round_up(capacity) - 1),
+    cells_(std::make_unique<cell[]>(mask_ + 1))
+  {
+    for (size_type i = 0; i <= mask_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  mpmc_bounded_string_queue(const mpmc_bounded_string_queue &) = delete;
+  mpmc_bounded_string_queue & operator=(const mpmc_bounded_string_queue &) = delete;
+
+  /// Returns the number of cells in the queue.
+  size_type
+  capacity() const noexcept
+  {
+    return mask_ + 1;
+  }
+
+  // Non-blocking
+  /// Constructs a message in place if there is room.
+  /**
+   * @a fill is called with a cleared cell. If it throws, an empty message is
+   * published in its place, since the cell has already been claimed.
+   *
+   * \param fill Callable taking value_type &
+   * \return false if the queue is full
+   */
+  template<
+    typename Fill
+  >
+  bool
+  try_emplace(Fill && fill)
+  {
+    size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      cell & c = cells_[pos & mask_];
+      const size_type seq = c.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.value.clear();
+          try {
+            fill(c.value);
+          } catch (...) {
+            c.value.clear();
+            c.sequence.store(pos + 1, std::memory_order_release);
+            notify(push_epoch_, pop_waiters_);
+            throw;
+          }
+          c.sequence.store(pos + 1, std::memory_order_release);
+          notify(push_epoch_, pop_waiters_);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Copies @a sv into the queue if there is room.
+  /**
+   * \return false if the queue is full
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  bool
+  try_push(view_type sv)
+  {
+    check_length(sv);
+    return try_emplace([sv](value_type & value) { value.assign(sv); });
+  }
+
+  /// Passes the oldest message to @a read in place, if there is one, and removes it.
+  /**
+   * The cell is only handed back to producers after @a read returns.
+   *
+   * \param read Callable taking const value_type &
+   * \return false if the queue is empty
+   */
+  template<
+    typename Read
+  >
+  bool
+  try_consume(Read && read)
+  {
+    size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      cell & c = cells_[pos & mask_];
+      const size_type seq = c.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          try {
+            read(static_cast<const value_type &>(c.value));
+          } catch (...) {
+            c.sequence.store(pos + mask_ + 1, std::memory_order_release);
+            notify(pop_epoch_, push_waiters_);
+            throw;
+          }
+          c.sequence.store(pos + mask_ + 1, std::memory_order_release);
+          notify(pop_epoch_, push_waiters_);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Moves the oldest message into @a out, if there is one.
+  /**
+   * \return false if the queue is empty
+   */
+  bool
+  try_pop(value_type & out)
+  noexcept
+  {
+    return try_consume([&out](const value_type & value) { out.assign(value.view()); });
+  }
+
+  // Spinning
+  /// Constructs a message in place, spinning while the queue is full.
+  template<
+    typename Fill
+  >
+  void
+  spin_emplace(Fill && fill)
+  {
+    while (!try_emplace(fill)) {
+      std::this_thread::yield();
+    }
+  }
+
+  /// Copies @a sv into the queue, spinning while the queue is full.
+  /**
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  void
+  spin_push(view_type sv)
+  {
+    check_length(sv);
+    spin_emplace([sv](value_type & value) { value.assign(sv); });
+  }
+
+  /// Reads the oldest message in place, spinning while the queue is empty.
+  template<
+    typename Read
+  >
+  void
+  spin_consume(Read && read)
+  {
+    while (!try_consume(read)) {
+      std::this_thread::yield();
+    }
+  }
+
+  /// Moves the oldest message into @a out, spinning while the queue is empty.
+  void
+  spin_pop(value_type & out)
+  noexcept
+  {
+    spin_consume([&out](const value_type & value) { out.assign(value.view()); });
+  }
+
+  // Blocking
+  /// Constructs a message in place, blocking while the queue is full.
+  template<
+    typename Fill
+  >
+  void
+  emplace(Fill && fill)
+  {
+    block_until(pop_epoch_, push_waiters_, [&] { return try_emplace(fill); });
+  }
+
+  /// Copies @a sv into the queue, blocking while the queue is full.
+  /**
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  void
+  push(view_type sv)
+  {
+    check_length(sv);
+    emplace([sv](value_type & value) { value.assign(sv); });
+  }
+
+  /// Reads the oldest message in place, blocking while the queue is empty.
+  template<
+    typename Read
+  >
+  void
+  consume(Read && read)
+  {
+    block_until(push_epoch_, pop_waiters_, [&] { return try_consume(read); });
+  }
+
+  /// Moves the oldest message into @a out, blocking while the queue is empty.
+  void
+  pop(value_type & out)
+  noexcept
+  {
+    consume([&out](const value_type & value) { out.assign(value.view()); });
+  }
+
+private:
+  struct alignas(bounded_string_cache_line_size) cell
+  {
+    std::atomic<size_type> sequence;
+    value_type value;
+  };
+
+  static size_type
+  round_up(size_type capacity)
+  {
+    if (capacity < 2) {
+      bounded_string_detail::throw_length_error("Queue capacity must be at least two");
+    }
+    if (capacity > (std::numeric_limits<size_type>::max() >> 1U) + 1) {
+      bounded_string_detail::throw_length_error("Queue capacity too large");
+    }
+    size_type rounded = 2;
+    while (rounded < capacity) {
+      rounded <<= 1U;
+    }
+    return rounded;
+  }
+
+  static void
+  check_length(view_type sv)
+  {
+    if (sv.size() > UpperBound) {
+      bounded_string_detail::throw_length_error();
+    }
+  }
+
+  /// Wakes one thread blocked on @a epoch, if there is any.
+  /**
+   * The fence orders the preceding cell publication before the waiter count
+   * is read, so either a blocking thread sees the cell on its re-check or we
+   * see it registered. Uncontended producers and consumers therefore only pay
+   * for a fence and a read of a rarely written line.
+   */
+  static void
+  notify(std::atomic<std::uint32_t> & epoch, std::atomic<std::uint32_t> & waiters)
+  noexcept
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_acquire) != 0) {
+      epoch.fetch_add(1, std::memory_order_release);
+      bounded_string_detail::futex_wake(epoch, 1);
+    }
+  }
+
+  /// Retries @a attempt, sleeping on @a epoch between failures.
+  /**
+   * The epoch is sampled before registering as a waiter and re-checking, so a
+   * notify() that lands between the failed attempt and the wait makes the
+   * wait return immediately.
+   */
+  template<
+    typename Attempt
+  >
+  static void
+  block_until(
+    std::atomic<std::uint32_t> & epoch,
+    std::atomic<std::uint32_t> & waiters,
+    Attempt && attempt)
+  {
+    while (!attempt()) {
+      const std::uint32_t seen = epoch.load(std::memory_order_acquire);
+      waiters.fetch_add(1, std::memory_order_seq_cst);
+      if (attempt()) {
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return;
+      }
+      bounded_string_detail::futex_wait(epoch, seen);
+      waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  const size_type mask_;
+  const std::unique_ptr<cell[]> cells_;
+
+  alignas(bounded_string_cache_line_size) std::atomic<size_type> enqueue_pos_{0};
+  alignas(bounded_string_cache_line_size) std::atomic<size_type> dequeue_pos_{0};
+
+  // Bumped after a push (pop) when consumers (producers) are blocked in the futex
+  alignas(bounded_string_cache_line_size) std::atomic<std::uint32_t> push_epoch_{0};
+  std::atomic<std::uint32_t> pop_waiters_{0};
+  alignas(bounded_string_cache_line_size) std::atomic<std::uint32_t> pop_epoch_{0};
+  std::atomic<std::uint32_t> push_waiters_{0};
+};
+
+#endif /* MPMC_BOUNDED_STRING_QUEUE_HPP */
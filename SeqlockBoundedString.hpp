@@ -0,0 +1,176 @@
+#ifndef SEQLOCK_BOUNDED_STRING_HPP
+#define SEQLOCK_BOUNDED_STRING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "InlineBoundedString.hpp"
+
+/// A bounded string shared by a single writer and many lock-free readers.
+/**
+ * The value lives in an %inline_bounded_basic_string guarded by a sequence
+ * counter. The writer makes the counter odd, copies the new value in and makes
+ * the counter even again; it never waits for readers. Readers copy the value
+ * out and retry if the counter was odd or changed while copying, so a read
+ * costs two counter loads and one copy of the used part of the buffer.
+ *
+ * The payload is stored as an array of relaxed atomic words so that the racy
+ * copy performed by readers is well defined.
+ *
+ * \tparam CharT Type of character
+ * \tparam UpperBound The upper bound for the number of characters
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits = std::char_traits<CharT>
+>
+class seqlock_bounded_basic_string
+{
+public:
+  using value_type = inline_bounded_basic_string<CharT, UpperBound, Traits>;
+  using size_type = typename value_type::size_type;
+  using view_type = typename value_type::view_type;
+
+  static_assert(std::is_trivially_copyable_v<value_type>,
+    "seqlock payload must be trivially copyable");
+
+  /// Create a %seqlock_bounded_basic_string holding an empty string.
+  seqlock_bounded_basic_string()
+  noexcept
+  : seqlock_bounded_basic_string(value_type())
+  {}
+
+  /// Create a %seqlock_bounded_basic_string holding a copy of @a value.
+  explicit
+  seqlock_bounded_basic_string(const value_type & value)
+  noexcept
+  {
+    copy_in(value);
+  }
+
+  seqlock_bounded_basic_string(const seqlock_bounded_basic_string &) = delete;
+  seqlock_bounded_basic_string & operator=(const seqlock_bounded_basic_string &) = delete;
+
+  /// Returns a consistent snapshot of the current value.
+  /**
+   * Never blocks the writer; spins only while a write is in progress.
+   */
+  value_type
+  load() const
+  noexcept
+  {
+    value_type out;
+    while (!try_load(out)) {
+    }
+    return out;
+  }
+
+  /// Makes a single attempt to read a consistent snapshot into @a out.
+  /**
+   * \param out Receives the value; only meaningful if true is returned
+   * \return false if a write overlapped the read
+   */
+  bool
+  try_load(value_type & out) const
+  noexcept
+  {
+    const std::uint64_t before = seq_.load(std::memory_order_acquire);
+    if ((before & 1U) != 0) {
+      return false;
+    }
+    copy_out(out);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq_.load(std::memory_order_relaxed) == before;
+  }
+
+  /// Publishes @a value. Must only be called from the single writer thread.
+  void
+  store(const value_type & value)
+  noexcept
+  {
+    const std::uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    copy_in(value);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  /// Publishes the contents of @a sv. Must only be called from the single writer thread.
+  /**
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  void
+  store(view_type sv)
+  {
+    store(value_type(sv));
+  }
+
+  /// Returns the number of completed writes.
+  std::uint64_t
+  version() const
+  noexcept
+  {
+    return seq_.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  using word_type = std::uintptr_t;
+  static constexpr std::size_t word_count =
+    (sizeof(value_type) + sizeof(word_type) - 1) / sizeof(word_type);
+
+  static constexpr std::size_t
+  words_for(std::size_t bytes) noexcept
+  {
+    return (bytes + sizeof(word_type) - 1) / sizeof(word_type);
+  }
+
+  void
+  copy_in(const value_type & value)
+  noexcept
+  {
+    const std::size_t bytes = value_type::used_bytes(value.size());
+    const std::size_t count = words_for(bytes);
+    word_type words[word_count];
+    words[count - 1] = 0;
+    std::memcpy(words, static_cast<const void *>(&value), bytes);
+    for (std::size_t i = 0; i < count; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  void
+  copy_out(value_type & out) const
+  noexcept
+  {
+    // The first word holds the size; a torn value is clamped by used_bytes()
+    // and discarded by the caller when the sequence check fails.
+    word_type words[word_count];
+    words[0] = words_[0].load(std::memory_order_relaxed);
+    size_type size = 0;
+    std::memcpy(&size, words, sizeof(size));
+    const std::size_t bytes = value_type::used_bytes(size);
+    const std::size_t count = words_for(bytes);
+    for (std::size_t i = 1; i < count; ++i) {
+      words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(static_cast<void *>(&out), words, bytes);
+  }
+
+  alignas(bounded_string_cache_line_size) std::atomic<std::uint64_t> seq_{0};
+  std::atomic<word_type> words_[word_count];
+};
+
+/// A %seqlock_bounded_basic_string of char.
+template<
+  std::size_t UpperBound
+>
+using seqlock_bounded_string = seqlock_bounded_basic_string<char, UpperBound>;
+
+#endif /* SEQLOCK_BOUNDED_STRING_HPP */
@@ -0,0 +1,587 @@
+#ifndef SHARED_MEMORY_BOUNDED_STRING_HPP
+#define SHARED_MEMORY_BOUNDED_STRING_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+#if defined(__unix__)
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include "BoundedStringError.hpp"
+#include "BoundedStringSimd.hpp"
+#include "InlineBoundedString.hpp"
+
+/// True if objects of type T may be placed in memory shared between processes.
+/**
+ * Such objects must be trivially copyable and standard-layout and must not
+ * hold pointers, which is the case for %inline_bounded_basic_string.
+ * std::basic_string, and so bounded_basic_string, hold pointers into the
+ * owning process and are never safe.
+ *
+ * Pointers and member pointers, and arrays of them, are rejected, but C++17
+ * cannot look inside a class: a trivially copyable struct with a pointer
+ * member passes, so structs placed in shared memory must be built from
+ * pointer-free members by their author.
+ */
+template<
+  typename T
+>
+inline constexpr bool is_shared_memory_safe_v =
+  std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T> &&
+  !std::is_pointer_v<std::remove_all_extents_t<T>> &&
+  !std::is_member_pointer_v<std::remove_all_extents_t<T>>;
+
+static_assert(is_shared_memory_safe_v<inline_bounded_string<64>>,
+  "inline bounded strings must be placeable in shared memory");
+
+namespace bounded_string_detail
+{
+
+/// The first bytes of every shared-memory container, used to validate attach().
+/**
+ * create() stores @a magic last with release ordering and attach() loads it
+ * with acquire ordering, so an attaching process sees the whole container.
+ */
+struct shm_header
+{
+  std::atomic<std::uint64_t> magic;
+  std::uint64_t layout;
+  std::uint64_t capacity;
+};
+
+inline constexpr std::uint64_t shm_magic = 0x4253'484d'5354'5231ULL;  // "BSHMSTR1"
+
+inline std::atomic<std::uint32_t> shm_cached_pid{0};
+
+/// Returns the process id recorded as the owner of shared-memory locks.
+/**
+ * The id is cached, and the cache is cleared in the child after fork().
+ * Without POSIX every process is reported as 1.
+ */
+inline std::uint32_t
+shm_owner_id() noexcept
+{
+#if defined(__unix__)
+  std::uint32_t pid = shm_cached_pid.load(std::memory_order_relaxed);
+  if (pid == 0) {
+    static const int registered = ::pthread_atfork(nullptr, nullptr,
+      [] { shm_cached_pid.store(0, std::memory_order_relaxed); });
+    static_cast<void>(registered);
+    pid = static_cast<std::uint32_t>(::getpid());
+    shm_cached_pid.store(pid, std::memory_order_relaxed);
+  }
+  return pid;
+#else
+  return 1;
+#endif
+}
+
+/// Returns true if the process @a owner has exited.
+inline bool
+shm_owner_dead(std::uint32_t owner) noexcept
+{
+#if defined(__unix__)
+  return ::kill(static_cast<pid_t>(owner), 0) == -1 && errno == ESRCH;
+#else
+  static_cast<void>(owner);
+  return false;
+#endif
+}
+
+/// How many times a waiter yields between checks that the owner is still alive.
+inline constexpr unsigned shm_liveness_interval = 256;
+
+/// Describes a container instantiation so that mismatched attaches are refused.
+template<
+  typename Cell
+>
+constexpr std::uint64_t
+shm_layout(std::uint64_t kind) noexcept
+{
+  return (kind << 56U) ^ (static_cast<std::uint64_t>(alignof(Cell)) << 40U) ^ sizeof(Cell);
+}
+
+inline constexpr std::size_t
+shm_cells_offset(std::size_t header_size, std::size_t cell_alignment) noexcept
+{
+  return (header_size + cell_alignment - 1) & ~(cell_alignment - 1);
+}
+
+}  // namespace bounded_string_detail
+
+/// A multi-producer, multi-consumer ring of inline bounded strings living in shared memory.
+/**
+ * The ring is created in place in a caller-provided region, e.g. one mapped
+ * with shm_open and mmap, and other processes attach to the same region.
+ * It contains no pointers: cells are located by their offset from the ring
+ * itself, so every process may map the region at a different address. Cells
+ * use Vyukov's per-cell sequence numbers, and all synchronisation is done
+ * with lock-free, address-free atomics. A process which dies between claiming
+ * a cell and publishing or releasing it stalls the ring at that cell.
+ *
+ * \tparam CharT Type of character
+ * \tparam UpperBound The upper bound for the number of characters in a message
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits = std::char_traits<CharT>
+>
+class shm_bounded_string_ring
+{
+public:
+  using value_type = inline_bounded_basic_string<CharT, UpperBound, Traits>;
+  using size_type = std::size_t;
+  using view_type = typename value_type::view_type;
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+    "shared-memory atomics must be lock-free");
+
+  /// Returns the number of bytes needed for a ring of @a capacity messages.
+  /**
+   * \param capacity The number of cells; must be a power of two
+   */
+  static constexpr size_type
+  bytes_required(size_type capacity) noexcept
+  {
+    return cells_offset() + capacity * sizeof(cell);
+  }
+
+  /// Creates an empty ring in @a memory, which must hold bytes_required(@a capacity) bytes.
+  /**
+   * \param memory Start of the region, aligned to bounded_string_cache_line_size
+   * \param capacity The number of cells; must be a power of two of at least two
+   * \throws invalid_argument If @a capacity is not a power of two of at least two
+   */
+  static shm_bounded_string_ring *
+  create(void * memory, size_type capacity)
+  {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+      throw std::invalid_argument("Ring capacity must be a power of two of at least two");
+    }
+    auto * ring = new (memory) shm_bounded_string_ring(capacity);
+    for (size_type i = 0; i < capacity; ++i) {
+      new (&ring->cells()[i]) cell();
+      ring->cells()[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    // Publish the header last so attach() never sees a half-built ring
+    ring->header_.magic.store(bounded_string_detail::shm_magic, std::memory_order_release);
+    return ring;
+  }
+
+  /// Attaches to a ring created by create(), possibly in another process.
+  /**
+   * \throws runtime_error If @a memory does not hold a ring of this type
+   */
+  static shm_bounded_string_ring *
+  attach(void * memory)
+  {
+    auto * ring = static_cast<shm_bounded_string_ring *>(memory);
+    if (ring->header_.magic.load(std::memory_order_acquire) != bounded_string_detail::shm_magic ||
+      ring->header_.layout != layout)
+    {
+      throw std::runtime_error("Shared memory does not hold a matching ring");
+    }
+    return ring;
+  }
+
+  shm_bounded_string_ring(const shm_bounded_string_ring &) = delete;
+  shm_bounded_string_ring & operator=(const shm_bounded_string_ring &) = delete;
+
+  /// Returns the number of cells in the ring.
+  size_type
+  capacity() const noexcept
+  {
+    return static_cast<size_type>(header_.capacity);
+  }
+
+  /// Constructs a message in place if there is room.
+  /**
+   * \param fill Callable taking value_type &; must not throw
+   * \return false if the ring is full
+   */
+  template<
+    typename Fill
+  >
+  bool
+  try_emplace(Fill && fill)
+  noexcept
+  {
+    std::uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      cell & c = cells()[pos & (capacity() - 1)];
+      const std::uint64_t seq = c.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::int64_t>(seq - pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.value.clear();
+          fill(c.value);
+          c.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Copies @a sv into the ring if there is room.
+  /**
+   * \return false if the ring is full
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  bool
+  try_push(view_type sv)
+  {
+    if (sv.size() > UpperBound) {
+      bounded_string_detail::throw_length_error();
+    }
+    return try_emplace([sv](value_type & value) { value.assign(sv); });
+  }
+
+  /// Passes the oldest message to @a read in place, if there is one, and removes it.
+  /**
+   * \param read Callable taking const value_type &; must not throw
+   * \return false if the ring is empty
+   */
+  template<
+    typename Read
+  >
+  bool
+  try_consume(Read && read)
+  noexcept
+  {
+    std::uint64_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      cell & c = cells()[pos & (capacity() - 1)];
+      const std::uint64_t seq = c.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::int64_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          read(static_cast<const value_type &>(c.value));
+          c.sequence.store(pos + capacity(), std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Copies the oldest message into @a out, if there is one.
+  /**
+   * \return false if the ring is empty
+   */
+  bool
+  try_pop(value_type & out)
+  noexcept
+  {
+    return try_consume([&out](const value_type & value) { out.assign(value.view()); });
+  }
+
+private:
+  struct alignas(bounded_string_cache_line_size) cell
+  {
+    std::atomic<std::uint64_t> sequence{0};
+    value_type value;
+  };
+
+  static constexpr std::uint64_t layout = bounded_string_detail::shm_layout<cell>(1);
+
+  explicit
+  shm_bounded_string_ring(size_type capacity) noexcept
+  : header_{{0}, layout, capacity}
+  {}
+
+  static constexpr size_type
+  cells_offset() noexcept
+  {
+    return bounded_string_detail::shm_cells_offset(sizeof(shm_bounded_string_ring), alignof(cell));
+  }
+
+  cell *
+  cells() noexcept
+  {
+    return reinterpret_cast<cell *>(reinterpret_cast<unsigned char *>(this) + cells_offset());
+  }
+
+  bounded_string_detail::shm_header header_;
+  alignas(bounded_string_cache_line_size) std::atomic<std::uint64_t> enqueue_pos_{0};
+  alignas(bounded_string_cache_line_size) std::atomic<std::uint64_t> dequeue_pos_{0};
+};
+
+/// A fixed-capacity hash map of inline bounded keys to values living in shared memory.
+/**
+ * Created in place in a caller-provided region and attached from other
+ * processes like %shm_bounded_string_ring. Uses open addressing with linear
+ * probing over pointer-free buckets. Inserting a new key claims an empty
+ * bucket with a CAS, and each bucket's value is guarded by a small spinlock,
+ * so any number of processes may look up and insert or assign concurrently.
+ * Keys cannot be erased.
+ *
+ * Claims and locks record the owner's process id. A process waiting on one
+ * periodically checks that the owner is alive, and if it has exited, returns
+ * a half-inserted bucket to empty or takes over the lock. A value being
+ * assigned when its writer died may be left partially written, and size() may
+ * miss a key whose inserter died. Recovery needs every process in one PID
+ * namespace and can be fooled by a dead owner's id being reused.
+ *
+ * \tparam CharT Type of character
+ * \tparam KeyBound The upper bound for the number of characters in a key
+ * \tparam ValueBound The upper bound for the number of characters in a value
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t KeyBound,
+  std::size_t ValueBound,
+  typename Traits = std::char_traits<CharT>
+>
+class shm_bounded_string_hash_map
+{
+public:
+  using key_type = inline_bounded_basic_string<CharT, KeyBound, Traits>;
+  using mapped_type = inline_bounded_basic_string<CharT, ValueBound, Traits>;
+  using size_type = std::size_t;
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+    "shared-memory atomics must be lock-free");
+
+  /// Returns the number of bytes needed for a map with @a capacity buckets.
+  static constexpr size_type
+  bytes_required(size_type capacity) noexcept
+  {
+    return buckets_offset() + capacity * sizeof(bucket);
+  }
+
+  /// Creates an empty map in @a memory, which must hold bytes_required(@a capacity) bytes.
+  /**
+   * \param memory Start of the region, aligned to alignof(std::max_align_t)
+   * \param capacity The number of buckets; must be a power of two
+   * \throws invalid_argument If @a capacity is not a power of two
+   */
+  static shm_bounded_string_hash_map *
+  create(void * memory, size_type capacity)
+  {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+      throw std::invalid_argument("Map capacity must be a power of two");
+    }
+    auto * map = new (memory) shm_bounded_string_hash_map(capacity);
+    for (size_type i = 0; i < capacity; ++i) {
+      new (&map->buckets()[i]) bucket();
+    }
+    map->header_.magic.store(bounded_string_detail::shm_magic, std::memory_order_release);
+    return map;
+  }
+
+  /// Attaches to a map created by create(), possibly in another process.
+  /**
+   * \throws runtime_error If @a memory does not hold a map of this type
+   */
+  static shm_bounded_string_hash_map *
+  attach(void * memory)
+  {
+    auto * map = static_cast<shm_bounded_string_hash_map *>(memory);
+    if (map->header_.magic.load(std::memory_order_acquire) != bounded_string_detail::shm_magic ||
+      map->header_.layout != layout)
+    {
+      throw std::runtime_error("Shared memory does not hold a matching map");
+    }
+    return map;
+  }
+
+  shm_bounded_string_hash_map(const shm_bounded_string_hash_map &) = delete;
+  shm_bounded_string_hash_map & operator=(const shm_bounded_string_hash_map &) = delete;
+
+  /// Returns the number of buckets.
+  size_type
+  capacity() const noexcept
+  {
+    return static_cast<size_type>(header_.capacity);
+  }
+
+  /// Returns the number of keys inserted so far.
+  size_type
+  size() const noexcept
+  {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  /// Inserts @a key with @a value, or replaces the value if @a key is present.
+  /**
+   * \return false if @a key is new and the map is full
+   * \throws length_error If @a key or @a value exceed their bounds
+   */
+  bool
+  insert_or_assign(view_type key, view_type value)
+  {
+    const key_type k(key);
+    const mapped_type v(value);
+    const size_type mask = capacity() - 1;
+    size_type index = hash(key) & mask;
+    for (size_type probes = 0; probes < capacity(); ++probes, index = (index + 1) & mask) {
+      bucket & b = buckets()[index];
+      for (;;) {
+        std::uint32_t state = b.state.load(std::memory_order_acquire);
+        if (state == empty &&
+          b.state.compare_exchange_strong(state, bounded_string_detail::shm_owner_id(), std::memory_order_acquire))
+        {
+          b.key = k;
+          b.value = v;
+          b.state.store(full, std::memory_order_release);
+          size_.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        }
+        if (wait_until_full(b)) {
+          break;
+        }
+      }
+      if (b.key == k) {
+        lock(b);
+        b.value = v;
+        unlock(b);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Copies the value for @a key into @a out.
+  /**
+   * \return false if @a key is not present
+   */
+  bool
+  find(view_type key, mapped_type & out)
+  noexcept
+  {
+    const size_type mask = capacity() - 1;
+    size_type index = hash(key) & mask;
+    for (size_type probes = 0; probes < capacity(); ++probes, index = (index + 1) & mask) {
+      bucket & b = buckets()[index];
+      if (b.state.load(std::memory_order_acquire) == empty || !wait_until_full(b)) {
+        return false;
+      }
+      if (b.key.view() == key) {
+        lock(b);
+        out.assign(b.value.view());
+        unlock(b);
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  // Any other state is the process id of the claiming inserter
+  static constexpr std::uint32_t empty = 0;
+  static constexpr std::uint32_t full = ~std::uint32_t{0};
+
+  struct bucket
+  {
+    // empty -> claimed -> full, or back to empty if the claimer died; the key never changes once full
+    std::atomic<std::uint32_t> state{empty};
+    // 0, or the process id of the lock holder
+    std::atomic<std::uint32_t> locked{0};
+    key_type key;
+    mapped_type value;
+  };
+
+  static constexpr std::uint64_t layout = bounded_string_detail::shm_layout<bucket>(2);
+
+  explicit
+  shm_bounded_string_hash_map(size_type capacity) noexcept
+  : header_{{0}, layout, capacity}
+  {}
+
+  static size_type
+  hash(view_type key) noexcept
+  {
+    return static_cast<size_type>(
+      bounded_string_detail::hash_bytes(key.data(), key.size() * sizeof(CharT)));
+  }
+
+  /// Waits until @a b is full, returning false if it is or becomes empty.
+  /**
+   * A bucket left claimed by a process that has exited is returned to empty.
+   */
+  static bool
+  wait_until_full(bucket & b) noexcept
+  {
+    std::uint32_t state = b.state.load(std::memory_order_acquire);
+    for (unsigned spins = 1; state != full; ++spins) {
+      if (state == empty) {
+        return false;
+      }
+      if (spins % bounded_string_detail::shm_liveness_interval == 0 &&
+        bounded_string_detail::shm_owner_dead(state))
+      {
+        b.state.compare_exchange_strong(state, empty, std::memory_order_acquire);
+        continue;
+      }
+      std::this_thread::yield();
+      state = b.state.load(std::memory_order_acquire);
+    }
+    return true;
+  }
+
+  /// Locks @a b, taking the lock over if its holder has exited.
+  static void
+  lock(bucket & b) noexcept
+  {
+    const std::uint32_t self = bounded_string_detail::shm_owner_id();
+    std::uint32_t expected = 0;
+    for (unsigned spins = 1; !b.locked.compare_exchange_weak(expected, self, std::memory_order_acquire); ++spins) {
+      if (expected == 0) {
+        continue;
+      }
+      if (spins % bounded_string_detail::shm_liveness_interval == 0 &&
+        bounded_string_detail::shm_owner_dead(expected))
+      {
+        // The CAS retries with the dead holder's id and so takes the lock over
+        continue;
+      }
+      expected = 0;
+      std::this_thread::yield();
+    }
+  }
+
+  static void
+  unlock(bucket & b) noexcept
+  {
+    b.locked.store(0, std::memory_order_release);
+  }
+
+  static constexpr size_type
+  buckets_offset() noexcept
+  {
+    return bounded_string_detail::shm_cells_offset(sizeof(shm_bounded_string_hash_map), alignof(bucket));
+  }
+
+  bucket *
+  buckets() noexcept
+  {
+    return reinterpret_cast<bucket *>(reinterpret_cast<unsigned char *>(this) + buckets_offset());
+  }
+
+  bounded_string_detail::shm_header header_;
+  std::atomic<std::uint64_t> size_{0};
+};
+
+#endif /* SHARED_MEMORY_BOUNDED_STRING_HPP */
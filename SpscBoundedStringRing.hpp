@@ -0,0 +1,242 @@
+#ifndef SPSC_BOUNDED_STRING_RING_HPP
+#define SPSC_BOUNDED_STRING_RING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "BoundedStringError.hpp"
+#include "InlineBoundedString.hpp"
+
+/// A lock-free single-producer, single-consumer ring of inline bounded strings.
+/**
+ * Every slot holds an %inline_bounded_basic_string directly and is aligned to a
+ * cache line, so messages are written and read in place without allocation.
+ * The producer and consumer indices live on separate cache lines, and each
+ * side keeps a cached copy of the other side's index so that the shared index
+ * is only re-read when the ring looks full (or empty).
+ *
+ * Exactly one thread may call the producer functions (try_push, try_emplace,
+ * publish_batch) and exactly one thread may call the consumer functions
+ * (try_pop, try_consume, consume_batch).
+ *
+ * \tparam CharT Type of character
+ * \tparam UpperBound The upper bound for the number of characters in a message
+ * \tparam Traits The traits type for the string's characters, defaults to std::char_traits<CharT>
+ */
+template<
+  typename CharT,
+  std::size_t UpperBound,
+  typename Traits = std::char_traits<CharT>
+>
+class spsc_bounded_string_ring
+{
+public:
+  using value_type = inline_bounded_basic_string<CharT, UpperBound, Traits>;
+  using size_type = std::size_t;
+  using view_type = typename value_type::view_type;
+
+  /// Create a ring holding at least @a capacity messages.
+  /**
+   * \param capacity The minimum number of slots; rounded up to a power of two
+   * \throws length_error If @a capacity is zero or has no power of two above it
+   */
+  explicit
+  spsc_bounded_string_ring(size_type capacity)
+  : mask_(round_up(capacity) - 1),
+    slots_(std::make_unique<slot[]>(mask_ + 1))
+  {}
+
+  spsc_bounded_string_ring(const spsc_bounded_string_ring &) = delete;
+  spsc_bounded_string_ring & operator=(const spsc_bounded_string_ring &) = delete;
+
+  /// Returns the number of slots in the ring.
+  size_type
+  capacity() const noexcept
+  {
+    return mask_ + 1;
+  }
+
+  /// Returns an estimate of the number of queued messages.
+  size_type
+  size_approx() const noexcept
+  {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+
+  // Producer
+  /// Copies @a sv into the next free slot.
+  /**
+   * \return false if the ring is full
+   * \throws length_error If @a sv is longer than @p UpperBound
+   */
+  bool
+  try_push(view_type sv)
+  {
+    if (sv.size() > UpperBound) {
+      bounded_string_detail::throw_length_error();
+    }
+    return try_emplace([sv](value_type & value) { value.assign(sv); });
+  }
+
+  /// Constructs the next message in place.
+  /**
+   * @a fill is called with a cleared slot and may write to it directly. If it
+   * throws, nothing is published.
+   *
+   * \param fill Callable taking value_type &
+   * \return false if the ring is full
+   */
+  template<
+    typename Fill
+  >
+  bool
+  try_emplace(Fill && fill)
+  {
+    return publish_batch(1, [&fill](value_type & value, size_type) { fill(value); }) == 1;
+  }
+
+  /// Constructs up to @a count messages in place and publishes them together.
+  /**
+   * @a fill is called as fill(value, i) for i in [0, n), where n is the number
+   * of free slots, up to @a count. The messages become visible to the consumer
+   * with a single index update. If @a fill throws, only the messages already
+   * completed are published.
+   *
+   * \param count The maximum number of messages to write
+   * \param fill Callable taking (value_type &, size_type)
+   * \return The number of messages published
+   */
+  template<
+    typename Fill
+  >
+  size_type
+  publish_batch(size_type count, Fill && fill)
+  {
+    const size_type head = head_.load(std::memory_order_relaxed);
+    size_type free = capacity() - (head - cached_tail_);
+    if (free < count) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      free = capacity() - (head - cached_tail_);
+    }
+    const size_type n = std::min(count, free);
+    size_type done = 0;
+    try {
+      for (; done < n; ++done) {
+        value_type & value = slots_[(head + done) & mask_].value;
+        value.clear();
+        fill(value, done);
+      }
+    } catch (...) {
+      head_.store(head + done, std::memory_order_release);
+      throw;
+    }
+    if (n != 0) {
+      head_.store(head + n, std::memory_order_release);
+    }
+    return n;
+  }
+
+  // Consumer
+  /// Copies the oldest message into @a out and removes it.
+  /**
+   * \return false if the ring is empty
+   */
+  bool
+  try_pop(value_type & out)
+  noexcept
+  {
+    return try_consume([&out](const value_type & value) { out.assign(value.view()); });
+  }
+
+  /// Passes the oldest message to @a read in place and removes it.
+  /**
+   * The slot is only reused after @a read returns.
+   *
+   * \param read Callable taking const value_type &
+   * \return false if the ring is empty
+   */
+  template<
+    typename Read
+  >
+  bool
+  try_consume(Read && read)
+  {
+    return consume_batch(1, [&read](const value_type & value) { read(value); }) == 1;
+  }
+
+  /// Passes up to @a count of the oldest messages to @a read in order and removes them.
+  /**
+   * The slots are released to the producer with a single index update.
+   *
+   * \param count The maximum number of messages to consume
+   * \param read Callable taking const value_type &
+   * \return The number of messages consumed
+   */
+  template<
+    typename Read
+  >
+  size_type
+  consume_batch(size_type count, Read && read)
+  {
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    size_type available = cached_head_ - tail;
+    if (available < count) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      available = cached_head_ - tail;
+    }
+    const size_type n = std::min(count, available);
+    size_type done = 0;
+    try {
+      for (; done < n; ++done) {
+        read(static_cast<const value_type &>(slots_[(tail + done) & mask_].value));
+      }
+    } catch (...) {
+      tail_.store(tail + done, std::memory_order_release);
+      throw;
+    }
+    if (n != 0) {
+      tail_.store(tail + n, std::memory_order_release);
+    }
+    return n;
+  }
+
+private:
+  struct alignas(bounded_string_cache_line_size) slot
+  {
+    value_type value;
+  };
+
+  static size_type
+  round_up(size_type capacity)
+  {
+    if (capacity == 0) {
+      bounded_string_detail::throw_length_error("Ring capacity must be positive");
+    }
+    if (capacity > (std::numeric_limits<size_type>::max() >> 1U) + 1) {
+      bounded_string_detail::throw_length_error("Ring capacity too large");
+    }
+    size_type rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1U;
+    }
+    return rounded;
+  }
+
+  const size_type mask_;
+  const std::unique_ptr<slot[]> slots_;
+
+  // Written by the producer
+  alignas(bounded_string_cache_line_size) std::atomic<size_type> head_{0};
+  size_type cached_tail_ = 0;
+
+  // Written by the consumer
+  alignas(bounded_string_cache_line_size) std::atomic<size_type> tail_{0};
+  size_type cached_head_ = 0;
+};
+
+#endif /* SPSC_BOUNDED_STRING_RING_HPP */
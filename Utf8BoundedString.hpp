@@ -0,0 +1,362 @@
+#ifndef UTF8_BOUNDED_STRING_HPP
+#define UTF8_BOUNDED_STRING_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+#include "BoundedStringError.hpp"
+#include "BoundedStringSimd.hpp"
+#include "InlineBoundedString.hpp"
+
+/// The unit in which the bound of a %utf8_bounded_string is counted.
+enum class utf8_bound
+{
+  /// UTF-8 code units, e.g. for a byte-limited database column
+  bytes,
+  /// Unicode code points, e.g. for a character-limited field
+  code_points
+};
+
+/// What a %utf8_bounded_string does with input which would exceed its bound.
+enum class utf8_overflow
+{
+  /// Throw std::length_error and leave the string unchanged
+  error,
+  /// Keep as many whole code points as fit and drop the rest
+  truncate
+};
+
+/// Returns the longest prefix of the well-formed UTF-8 @a sv of at most @a max_bytes bytes.
+/**
+ * The prefix never ends inside a multi-byte sequence. Finding it inspects at
+ * most four bytes, whatever the length of @a sv.
+ */
+inline std::string_view
+utf8_truncate(std::string_view sv, std::size_t max_bytes)
+noexcept
+{
+  return sv.substr(0, bounded_string_detail::utf8_truncation_point(sv.data(), sv.size(), max_bytes));
+}
+
+/// Returns the longest prefix of the well-formed UTF-8 @a sv of at most @a max_code_points code points.
+inline std::string_view
+utf8_truncate_code_points(std::string_view sv, std::size_t max_code_points)
+noexcept
+{
+  return sv.substr(0, bounded_string_detail::utf8_code_point_offset(sv.data(), sv.size(), max_code_points));
+}
+
+/// A bounded string which always holds well-formed UTF-8.
+/**
+ * Input is validated on every assignment and append, so the contents are
+ * never ill-formed, and the bound is counted in bytes or in code points.
+ * Input which would exceed the bound either throws or, with
+ * utf8_overflow::truncate, is cut at the last code point which fits, never
+ * inside a multi-byte sequence.
+ *
+ * The characters live in an %inline_bounded_basic_string<char, ...> of
+ * max_bytes() bytes, so the class never allocates and is trivially copyable.
+ * Only const access to the characters is offered, since writing single bytes
+ * could break the encoding. Code units are char: char8_t needs C++20 and
+ * would not interoperate with std::string_view.
+ *
+ * \tparam Bound The upper bound, in @p Unit
+ * \tparam Unit The unit in which @p Bound is counted, defaults to bytes
+ * \tparam Overflow What to do with input which would exceed @p Bound, defaults to throwing
+ */
+template<
+  std::size_t Bound,
+  utf8_bound Unit = utf8_bound::bytes,
+  utf8_overflow Overflow = utf8_overflow::error,
+  typename = std::enable_if_t<(Bound > 0 && Bound <= static_cast<std::size_t>(-1) / 8)>
+>
+class utf8_bounded_string
+{
+  // A code point takes at most four bytes
+  static constexpr std::size_t byte_bound = Unit == utf8_bound::bytes ? Bound : 4 * Bound;
+
+public:
+  using storage_type = inline_bounded_basic_string<char, byte_bound>;
+  using value_type = char;
+  using size_type = std::size_t;
+  using const_pointer = const char *;
+  using const_iterator = const char *;
+  using view_type = std::string_view;
+
+  // Constructors
+  /// Create an empty %utf8_bounded_string object.
+  utf8_bounded_string() noexcept = default;
+
+  /// Create a %utf8_bounded_string from a null-terminated UTF-8 string.
+  /**
+   * \param s Pointer to a null-terminated character string
+   * \throws invalid_argument If @a s is not well-formed UTF-8
+   * \throws length_error If @a s exceeds @p Bound and @p Overflow is utf8_overflow::error
+   */
+  explicit
+  utf8_bounded_string(
+    const char * s)
+  {
+    assign(view_type(s));
+  }
+
+  /// Create a %utf8_bounded_string from a UTF-8 string view.
+  /**
+   * \param sv The string view to copy from
+   * \throws invalid_argument If @a sv is not well-formed UTF-8
+   * \throws length_error If @a sv exceeds @p Bound and @p Overflow is utf8_overflow::error
+   */
+  explicit
+  utf8_bounded_string(
+    view_type sv)
+  {
+    assign(sv);
+  }
+
+  /// %utf8_bounded_string cannot be constructed from nullptr.
+  utf8_bounded_string(std::nullptr_t) = delete;
+
+  // Assignment
+  /// Replace the contents with those of a null-terminated UTF-8 string.
+  utf8_bounded_string &
+  operator=(const char * s)
+  {
+    return assign(view_type(s));
+  }
+
+  /// Replace the contents with those of a UTF-8 string view.
+  utf8_bounded_string &
+  operator=(view_type sv)
+  {
+    return assign(sv);
+  }
+
+  /// Replace the contents with those of a UTF-8 string view.
+  /**
+   * \param sv The string view to copy from
+   * \return L-value reference to *this
+   * \throws invalid_argument If @a sv is not well-formed UTF-8; the string is unchanged
+   * \throws length_error If @a sv exceeds @p Bound and @p Overflow is utf8_overflow::error;
+   *   the string is unchanged
+   */
+  utf8_bounded_string &
+  assign(view_type sv)
+  {
+    validate(sv);
+    storage_.assign(sv.data(), fit(sv, 0, 0));
+    return *this;
+  }
+
+  // Capacity
+  /// Returns the number of bytes in the string.
+  size_type
+  size() const noexcept
+  {
+    return storage_.size();
+  }
+
+  /// Returns the number of bytes in the string.
+  size_type
+  length() const noexcept
+  {
+    return storage_.size();
+  }
+
+  /// Returns the number of code points in the string, counted a vector at a time.
+  size_type
+  size_codepoints() const noexcept
+  {
+    return bounded_string_detail::count_utf8_code_points(storage_.data(), storage_.size());
+  }
+
+  /// Checks whether the string is empty.
+  bool
+  empty() const noexcept
+  {
+    return storage_.empty();
+  }
+
+  /// Returns the upper bound, in @p Unit.
+  static constexpr size_type
+  max_size() noexcept
+  {
+    return Bound;
+  }
+
+  /// Returns the most bytes the string can hold.
+  static constexpr size_type
+  max_bytes() noexcept
+  {
+    return byte_bound;
+  }
+
+  // Element access
+  const_pointer data() const noexcept { return storage_.data(); }
+  const_pointer c_str() const noexcept { return storage_.c_str(); }
+  const storage_type & storage() const noexcept { return storage_; }
+
+  /// Returns a view of the whole string.
+  view_type
+  view() const noexcept
+  {
+    return storage_.view();
+  }
+
+  /// Returns a view of the whole string.
+  operator view_type() const noexcept
+  {
+    return storage_.view();
+  }
+
+  // Iterators
+  const_iterator begin() const noexcept { return storage_.begin(); }
+  const_iterator cbegin() const noexcept { return storage_.cbegin(); }
+  const_iterator end() const noexcept { return storage_.end(); }
+  const_iterator cend() const noexcept { return storage_.cend(); }
+
+  // Operations
+  /// Removes all characters from the string.
+  void
+  clear()
+  noexcept
+  {
+    storage_.clear();
+  }
+
+  /// Appends a UTF-8 string view.
+  /**
+   * \param sv The string view to append
+   * \return L-value reference to *this
+   * \throws invalid_argument If @a sv is not well-formed UTF-8; the string is unchanged
+   * \throws length_error If the result would exceed @p Bound and @p Overflow is
+   *   utf8_overflow::error; the string is unchanged
+   */
+  utf8_bounded_string &
+  append(view_type sv)
+  {
+    validate(sv);
+    return append_valid(sv);
+  }
+
+  utf8_bounded_string & operator+=(view_type sv) { return append(sv); }
+
+  /// Appends the UTF-8 encoding of the code point @a cp.
+  /**
+   * \throws invalid_argument If @a cp is a surrogate or above U+10FFFF
+   * \throws length_error If @a cp does not fit and @p Overflow is utf8_overflow::error;
+   *   with utf8_overflow::truncate it is dropped
+   */
+  void
+  push_back(char32_t cp)
+  {
+    char bytes[4];
+    size_type count = 0;
+    if (cp < 0x80) {
+      bytes[count++] = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+      bytes[count++] = static_cast<char>(0xC0 | (cp >> 6U));
+      bytes[count++] = static_cast<char>(0x80 | (cp & 0x3FU));
+    } else if (cp < 0x10000) {
+      if (cp >= 0xD800 && cp <= 0xDFFF) {
+        bounded_string_detail::throw_invalid_utf8();
+      }
+      bytes[count++] = static_cast<char>(0xE0 | (cp >> 12U));
+      bytes[count++] = static_cast<char>(0x80 | ((cp >> 6U) & 0x3FU));
+      bytes[count++] = static_cast<char>(0x80 | (cp & 0x3FU));
+    } else if (cp <= 0x10FFFF) {
+      bytes[count++] = static_cast<char>(0xF0 | (cp >> 18U));
+      bytes[count++] = static_cast<char>(0x80 | ((cp >> 12U) & 0x3FU));
+      bytes[count++] = static_cast<char>(0x80 | ((cp >> 6U) & 0x3FU));
+      bytes[count++] = static_cast<char>(0x80 | (cp & 0x3FU));
+    } else {
+      bounded_string_detail::throw_invalid_utf8();
+    }
+    append_valid(view_type(bytes, count));
+  }
+
+  /// Removes the last code point; the string must not be empty.
+  void
+  pop_back()
+  noexcept
+  {
+    size_type count = storage_.size() - 1;
+    while (count > 0 && bounded_string_detail::is_utf8_continuation(storage_[count])) {
+      --count;
+    }
+    storage_.resize(count);
+  }
+
+  /// Exchanges the contents of two strings.
+  void
+  swap(utf8_bounded_string & other)
+  noexcept
+  {
+    storage_.swap(other.storage_);
+  }
+
+  // Comparison, bytewise and so in code point order
+  friend bool operator==(const utf8_bounded_string & lhs, const utf8_bounded_string & rhs) noexcept { return lhs.view() == rhs.view(); }
+  friend bool operator==(const utf8_bounded_string & lhs, view_type rhs) noexcept { return lhs.view() == rhs; }
+  friend bool operator==(view_type lhs, const utf8_bounded_string & rhs) noexcept { return lhs == rhs.view(); }
+  friend bool operator!=(const utf8_bounded_string & lhs, const utf8_bounded_string & rhs) noexcept { return lhs.view() != rhs.view(); }
+  friend bool operator!=(const utf8_bounded_string & lhs, view_type rhs) noexcept { return lhs.view() != rhs; }
+  friend bool operator!=(view_type lhs, const utf8_bounded_string & rhs) noexcept { return lhs != rhs.view(); }
+  friend bool operator<(const utf8_bounded_string & lhs, const utf8_bounded_string & rhs) noexcept { return lhs.view() < rhs.view(); }
+  friend bool operator<=(const utf8_bounded_string & lhs, const utf8_bounded_string & rhs) noexcept { return lhs.view() <= rhs.view(); }
+  friend bool operator>(const utf8_bounded_string & lhs, const utf8_bounded_string & rhs) noexcept { return lhs.view() > rhs.view(); }
+  friend bool operator>=(const utf8_bounded_string & lhs, const utf8_bounded_string & rhs) noexcept { return lhs.view() >= rhs.view(); }
+
+private:
+  static void
+  validate(view_type sv)
+  {
+    if (!bounded_string_detail::validate_utf8(sv.data(), sv.size())) {
+      bounded_string_detail::throw_invalid_utf8();
+    }
+  }
+
+  /// Appends the well-formed @a sv, applying the overflow policy.
+  utf8_bounded_string &
+  append_valid(view_type sv)
+  {
+    storage_.append(sv.data(), fit(sv, storage_.size(), unknown));
+    return *this;
+  }
+
+  static constexpr size_type unknown = static_cast<size_type>(-1);
+
+  /// Returns how many bytes of the well-formed @a sv fit after @a used_bytes bytes.
+  /**
+   * @a used_code_points is the number of code points already held, or
+   * unknown to count them only if needed. Throws if not all of @a sv fits
+   * and @p Overflow is utf8_overflow::error.
+   */
+  size_type
+  fit(view_type sv, size_type used_bytes, size_type used_code_points) const
+  {
+    // Every code point takes at least one byte, so this suffices for either unit
+    if (used_bytes <= Bound && sv.size() <= Bound - used_bytes) {
+      return sv.size();
+    }
+    size_type count = 0;
+    if constexpr (Unit == utf8_bound::bytes) {
+      count = bounded_string_detail::utf8_truncation_point(sv.data(), sv.size(), Bound - used_bytes);
+    } else {
+      if (used_code_points == unknown) {
+        used_code_points = size_codepoints();
+      }
+      count = bounded_string_detail::utf8_code_point_offset(sv.data(), sv.size(), Bound - used_code_points);
+    }
+    if constexpr (Overflow == utf8_overflow::error) {
+      if (count < sv.size()) {
+        bounded_string_detail::throw_length_error();
+      }
+    }
+    return count;
+  }
+
+  storage_type storage_;
+};
+
+#endif /* UTF8_BOUNDED_STRING_HPP */
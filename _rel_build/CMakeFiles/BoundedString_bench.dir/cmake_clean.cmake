@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "BoundedString_bench"
+  "BoundedString_bench.pdb"
+  "CMakeFiles/BoundedString_bench.dir/bench.cpp.o"
+  "CMakeFiles/BoundedString_bench.dir/bench.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BoundedString_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
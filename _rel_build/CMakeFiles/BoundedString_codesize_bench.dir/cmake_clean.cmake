@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "BoundedString_codesize_bench"
+  "BoundedString_codesize_bench.pdb"
+  "CMakeFiles/BoundedString_codesize_bench.dir/codesize_bench.cpp.o"
+  "CMakeFiles/BoundedString_codesize_bench.dir/codesize_bench.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BoundedString_codesize_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
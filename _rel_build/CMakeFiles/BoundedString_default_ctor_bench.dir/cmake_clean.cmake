@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "BoundedString_default_ctor_bench"
+  "BoundedString_default_ctor_bench.pdb"
+  "CMakeFiles/BoundedString_default_ctor_bench.dir/default_ctor_bench.cpp.o"
+  "CMakeFiles/BoundedString_default_ctor_bench.dir/default_ctor_bench.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BoundedString_default_ctor_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "BoundedString_false_sharing_bench"
+  "BoundedString_false_sharing_bench.pdb"
+  "CMakeFiles/BoundedString_false_sharing_bench.dir/false_sharing_bench.cpp.o"
+  "CMakeFiles/BoundedString_false_sharing_bench.dir/false_sharing_bench.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BoundedString_false_sharing_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "BoundedString_fuzz_replay"
+  "BoundedString_fuzz_replay.pdb"
+  "CMakeFiles/BoundedString_fuzz_replay.dir/fuzz_differential.cpp.o"
+  "CMakeFiles/BoundedString_fuzz_replay.dir/fuzz_differential.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BoundedString_fuzz_replay.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "BoundedString_mpmc_bench"
+  "BoundedString_mpmc_bench.pdb"
+  "CMakeFiles/BoundedString_mpmc_bench.dir/mpmc_bench.cpp.o"
+  "CMakeFiles/BoundedString_mpmc_bench.dir/mpmc_bench.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BoundedString_mpmc_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "BoundedString_spsc_bench"
+  "BoundedString_spsc_bench.pdb"
+  "CMakeFiles/BoundedString_spsc_bench.dir/spsc_bench.cpp.o"
+  "CMakeFiles/BoundedString_spsc_bench.dir/spsc_bench.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BoundedString_spsc_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
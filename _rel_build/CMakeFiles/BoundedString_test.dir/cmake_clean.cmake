@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "BoundedString_test"
+  "BoundedString_test.pdb"
+  "CMakeFiles/BoundedString_test.dir/test.cpp.o"
+  "CMakeFiles/BoundedString_test.dir/test.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BoundedString_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_rel_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(BoundedString_test "/root/repo/_rel_build/BoundedString_test")
+set_tests_properties(BoundedString_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;58;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(BoundedString_instrumented_test "/root/repo/_rel_build/BoundedString_instrumented_test")
+set_tests_properties(BoundedString_instrumented_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;75;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(BoundedString_fuzz_replay "/root/repo/_rel_build/BoundedString_fuzz_replay")
+set_tests_properties(BoundedString_fuzz_replay PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;81;add_test;/root/repo/CMakeLists.txt;0;")
@@ -0,0 +1,401 @@
+// Microbenchmarks of the bounded string types against std::string and std::string_view.
+//
+// Usage: BoundedString_bench [--filter=substring] [--min-time-ms=N] [--repetitions=N]
+//                            [--counters] [--alloc] [--json=file] [--csv=file]
+//                            [--baseline=file.json] [--threshold=percent] [--seed=N]
+//
+// Cases are named operation/type/bound/workload and cover construction,
+// assignment, insertion, push_back, ASCII case conversion, the find family,
+// compare, hashing, sorting, hash set lookups, copy and move for bounds 8, 16,
+// 64, 256 and 4096. Each runs on every workload from bench_workloads.hpp,
+// generated from --seed (default 0x5EED). Each iteration takes the next string
+// from a pool of 1024 inputs, so that branch predictors cannot learn a single
+// length.
+// std::string_view runs the cases which do not modify the string.
+//
+// With --alloc, a footprint table comes first: sizeof each type and the heap
+// bytes per string for every bound and workload. The timing table
+// then adds allocations and bytes allocated per operation, and the peak RSS
+// of the process is printed at the end.
+//
+// --json and --csv write every result to a file. --baseline compares the
+// medians with a JSON file from an earlier run and exits with status 1 if any
+// case got slower by more than the threshold (default 5%) and the noise of
+// the two runs; use --repetitions=10 or more for a stable verdict.
+//
+// Default construction is measured by BoundedString_default_ctor_bench.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "BoundedString.hpp"
+#include "BoundedStringSimd.hpp"
+#include "InlineBoundedString.hpp"
+#include "bench_alloc.hpp"
+#include "bench_harness.hpp"
+#include "bench_report.hpp"
+#include "bench_workloads.hpp"
+
+BOUNDED_STRING_BENCH_ALLOC_HOOKS
+
+namespace {
+
+constexpr std::size_t pool_size = 1024;
+constexpr std::size_t pool_mask = pool_size - 1;
+
+/// A pool of input strings no longer than one bound.
+struct input_set
+{
+  std::vector<std::string> strings;
+  /// Short substrings to search for, about half of which occur in the matching string
+  std::vector<std::string> needles;
+  double mean_length = 0.0;
+};
+
+input_set
+make_inputs(bench::workload w, std::size_t bound, std::uint64_t seed)
+{
+  input_set in;
+  in.strings = bench::generate(w, bound, pool_size, seed);
+  bench::splitmix64 rng(seed + bound);
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < pool_size; ++i) {
+    const std::string & source = in.strings[rng.below(2) == 0 ? i : (i + 1) & pool_mask];
+    const std::size_t length = std::min<std::size_t>(3, source.size());
+    const std::size_t pos = source.size() > length ? rng.below(source.size() - length) : 0;
+    in.needles.push_back(source.substr(pos, length));
+    total += in.strings[i].size();
+  }
+  in.mean_length = static_cast<double>(total) / pool_size;
+  return in;
+}
+
+/// Hashes the characters of any string type the same way, for a like-for-like comparison.
+struct view_hash
+{
+  template<
+    typename S
+  >
+  std::size_t
+  operator()(const S & s) const noexcept
+  {
+    return static_cast<std::size_t>(bounded_string_detail::hash_bytes(s.data(), s.size()));
+  }
+};
+
+struct view_equal
+{
+  template<
+    typename S
+  >
+  bool
+  operator()(const S & lhs, const S & rhs) const noexcept
+  {
+    return lhs.compare(std::string_view(rhs.data(), rhs.size())) == 0;
+  }
+};
+
+/// Runs the read-only cases, which every type including std::string_view supports.
+template<
+  typename S
+>
+void
+run_read_cases(bench::runner & r, const std::string & suffix, const input_set & in)
+{
+  std::vector<S> built;
+  for (const auto & s : in.strings) {
+    built.emplace_back(std::string_view(s));
+  }
+  const double bytes = in.mean_length;
+
+  r.run("ctor_view/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const S s(std::string_view(in.strings[i & pool_mask]));
+      bench::do_not_optimize(s);
+    }
+  });
+  r.run("copy_ctor/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const S s(built[i & pool_mask]);
+      bench::do_not_optimize(s);
+    }
+  });
+  r.run("find_char/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto pos = built[i & pool_mask].find('q');
+      bench::do_not_optimize(pos);
+    }
+  });
+  r.run("find_str/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto pos = built[i & pool_mask].find(std::string_view(in.needles[i & pool_mask]));
+      bench::do_not_optimize(pos);
+    }
+  });
+  r.run("rfind_char/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto pos = built[i & pool_mask].rfind('q');
+      bench::do_not_optimize(pos);
+    }
+  });
+  r.run("find_first_of/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto pos = built[i & pool_mask].find_first_of(std::string_view("xyz"));
+      bench::do_not_optimize(pos);
+    }
+  });
+  r.run("find_first_not_of/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto pos = built[i & pool_mask].find_first_not_of(std::string_view("abcdefghijklmnopqrstuvw"));
+      bench::do_not_optimize(pos);
+    }
+  });
+  r.run("find_last_of/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto pos = built[i & pool_mask].find_last_of(std::string_view("xyz"));
+      bench::do_not_optimize(pos);
+    }
+  });
+  r.run("find_last_not_of/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto pos = built[i & pool_mask].find_last_not_of(std::string_view("abcdefghijklmnopqrstuvw"));
+      bench::do_not_optimize(pos);
+    }
+  });
+  r.run("compare/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const S & rhs = built[(i + 1) & pool_mask];
+      const int result = built[i & pool_mask].compare(std::string_view(rhs.data(), rhs.size()));
+      bench::do_not_optimize(result);
+    }
+  });
+  r.run("hash/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::size_t h = view_hash()(built[i & pool_mask]);
+      bench::do_not_optimize(h);
+    }
+  });
+  std::vector<S> scratch = built;
+  r.run("sort/" + suffix, bytes * pool_size, [&](std::size_t n) {
+    // One operation sorts a copy of the whole pool
+    for (std::size_t i = 0; i < n; ++i) {
+      std::copy(built.begin(), built.end(), scratch.begin());
+      std::sort(scratch.begin(), scratch.end(), [](const S & lhs, const S & rhs) {
+        return lhs.compare(std::string_view(rhs.data(), rhs.size())) < 0;
+      });
+      bench::do_not_optimize(scratch.front());
+    }
+  });
+  const std::unordered_set<S, view_hash, view_equal> set(built.begin(), built.end());
+  std::vector<S> probes;
+  for (const auto & s : in.needles) {
+    probes.emplace_back(std::string_view(s));
+  }
+  r.run("set_find/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      // Alternate between present keys and keys which are usually absent
+      const S & key = (i & 1U) == 0 ? built[i & pool_mask] : probes[i & pool_mask];
+      const bool found = set.find(key) != set.end();
+      bench::do_not_optimize(found);
+    }
+  });
+}
+
+/// Runs the cases which build or modify strings.
+template<
+  typename S
+>
+void
+run_write_cases(bench::runner & r, const std::string & suffix, const input_set & in)
+{
+  std::vector<S> built;
+  for (const auto & s : in.strings) {
+    built.emplace_back(std::string_view(s));
+  }
+  const double bytes = in.mean_length;
+  S target(std::size_t{0}, 'x');
+
+  r.run("ctor_count_char/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const S s(in.strings[i & pool_mask].size(), 'x');
+      bench::do_not_optimize(s);
+    }
+  });
+  r.run("ctor_ptr_count/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::string & src = in.strings[i & pool_mask];
+      const S s(src.data(), src.size());
+      bench::do_not_optimize(s);
+    }
+  });
+  r.run("ctor_cstr/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const S s(in.strings[i & pool_mask].c_str());
+      bench::do_not_optimize(s);
+    }
+  });
+  if constexpr (std::is_constructible_v<S, const char *, const char *>) {
+    r.run("ctor_range/" + suffix, bytes, [&](std::size_t n) {
+      for (std::size_t i = 0; i < n; ++i) {
+        const std::string & src = in.strings[i & pool_mask];
+        const S s(src.data(), src.data() + src.size());
+        bench::do_not_optimize(s);
+      }
+    });
+  }
+  r.run("ctor_ilist/" + suffix, 8.0, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const S s{'b', 'o', 'u', 'n', 'd', 'e', 'd', '!'};
+      bench::do_not_optimize(s);
+    }
+  });
+  r.run("move_round_trip/" + suffix, bytes, [&](std::size_t n) {
+    // One move construction and one move assignment back into the pool
+    for (std::size_t i = 0; i < n; ++i) {
+      S & slot = built[i & pool_mask];
+      S moved(std::move(slot));
+      slot = std::move(moved);
+      bench::do_not_optimize(slot);
+    }
+  });
+  r.run("copy_assign/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      target = built[i & pool_mask];
+      bench::do_not_optimize(target);
+    }
+  });
+  r.run("assign_view/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      target.assign(std::string_view(in.strings[i & pool_mask]));
+      bench::do_not_optimize(target);
+    }
+  });
+  r.run("assign_count_char/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      target.assign(in.strings[i & pool_mask].size(), 'x');
+      bench::do_not_optimize(target);
+    }
+  });
+  r.run("insert_front/" + suffix, bytes, [&](std::size_t n) {
+    // Assigns the second half of the input, then inserts the first half before it
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::string_view src(in.strings[i & pool_mask]);
+      const std::size_t half = src.size() / 2;
+      target.assign(src.substr(half));
+      target.insert(0, src.substr(0, half));
+      bench::do_not_optimize(target);
+    }
+  });
+  r.run("push_back/" + suffix, bytes, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      target.clear();
+      for (const char ch : in.strings[i & pool_mask]) {
+        target.push_back(ch);
+      }
+      bench::do_not_optimize(target);
+    }
+  });
+  if constexpr (!std::is_same_v<S, std::string>) {
+    r.run("to_lower/" + suffix, bytes, [&](std::size_t n) {
+      // In place; the length never changes, so there is no bound check
+      for (std::size_t i = 0; i < n; ++i) {
+        S & s = built[i & pool_mask];
+        s.to_lower();
+        bench::do_not_optimize(s);
+      }
+    });
+  }
+}
+
+/// Prints the memory held by one string of type S built from each input.
+template<
+  typename S
+>
+void
+print_footprint(const std::string & suffix, const input_set & in, const std::string & filter)
+{
+  const std::string name = "footprint/" + suffix;
+  if (!filter.empty() && name.find(filter) == std::string::npos) {
+    return;
+  }
+  std::vector<S> built;
+  built.reserve(pool_size);
+  const std::size_t before = bench::global_alloc_stats.live_bytes;
+  for (const auto & s : in.strings) {
+    built.emplace_back(std::string_view(s));
+  }
+  const double heap = static_cast<double>(bench::global_alloc_stats.live_bytes - before) / pool_size;
+  std::printf("%-48s %12zu %12.1f %12.1f\n", name.c_str(), sizeof(S), heap,
+    static_cast<double>(sizeof(S)) + heap);
+}
+
+template<
+  std::size_t Bound
+>
+void
+print_footprint_bound(const std::string & filter, std::uint64_t seed)
+{
+  for (const bench::workload w : bench::all_workloads) {
+    const input_set in = make_inputs(w, Bound, seed);
+    const std::string tail = "/" + std::to_string(Bound) + "/" + bench::workload_name(w);
+    print_footprint<bounded_basic_string<char, Bound>>("bounded" + tail, in, filter);
+    print_footprint<inline_bounded_string<Bound>>("inline" + tail, in, filter);
+    print_footprint<std::string>("std::string" + tail, in, filter);
+  }
+}
+
+template<
+  std::size_t Bound
+>
+void
+run_bound(bench::runner & r)
+{
+  const std::uint64_t seed = r.opts().seed;
+  for (const bench::workload w : bench::all_workloads) {
+    const input_set in = make_inputs(w, Bound, seed);
+    const std::string tail = "/" + std::to_string(Bound) + "/" + bench::workload_name(w);
+    run_write_cases<bounded_basic_string<char, Bound>>(r, "bounded" + tail, in);
+    run_write_cases<inline_bounded_string<Bound>>(r, "inline" + tail, in);
+    run_write_cases<std::string>(r, "std::string" + tail, in);
+    run_read_cases<bounded_basic_string<char, Bound>>(r, "bounded" + tail, in);
+    run_read_cases<inline_bounded_string<Bound>>(r, "inline" + tail, in);
+    run_read_cases<std::string>(r, "std::string" + tail, in);
+    run_read_cases<std::string_view>(r, "std::string_view" + tail, in);
+  }
+}
+
+}  // namespace
+
+int
+main(int argc, char ** argv)
+{
+  bench::runner r(bench::options::parse(argc, argv));
+  if (r.opts().alloc) {
+    std::printf("%-48s %12s %12s %12s\n", "footprint", "sizeof", "heap/str", "total/str");
+    print_footprint_bound<8>(r.opts().filter, r.opts().seed);
+    print_footprint_bound<16>(r.opts().filter, r.opts().seed);
+    print_footprint_bound<64>(r.opts().filter, r.opts().seed);
+    print_footprint_bound<256>(r.opts().filter, r.opts().seed);
+    print_footprint_bound<4096>(r.opts().filter, r.opts().seed);
+    std::printf("\n");
+  }
+  r.print_header();
+  run_bound<8>(r);
+  run_bound<16>(r);
+  run_bound<64>(r);
+  run_bound<256>(r);
+  run_bound<4096>(r);
+  if (r.opts().alloc) {
+    std::printf("\npeak RSS: %ld KiB\n", bench::peak_rss_kib());
+  }
+  return bench::finish(r);
+}
@@ -0,0 +1,101 @@
+// Heap allocation accounting for the BoundedString benchmarks.
+//
+// The counters are plain globals updated by replacement global operator new
+// and delete, which a benchmark defines once by expanding
+// BOUNDED_STRING_BENCH_ALLOC_HOOKS at namespace scope in one source file.
+// They are not atomic: the benchmarks allocate from one thread only.
+// Byte counts are the allocator's usable sizes where glibc reports them,
+// so they include the allocator's rounding.
+
+#ifndef BOUNDED_STRING_BENCH_ALLOC_HPP
+#define BOUNDED_STRING_BENCH_ALLOC_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__unix__)
+#include <sys/resource.h>
+#endif
+
+namespace bench
+{
+
+struct alloc_stats
+{
+  /// Calls to operator new
+  std::size_t allocations = 0;
+  /// Bytes handed out by operator new
+  std::size_t bytes = 0;
+  /// Bytes allocated and not yet freed
+  std::size_t live_bytes = 0;
+};
+
+inline alloc_stats global_alloc_stats;
+
+inline std::size_t
+usable_size(void * ptr, std::size_t requested) noexcept
+{
+#if defined(__GLIBC__)
+  (void)requested;
+  return malloc_usable_size(ptr);
+#else
+  (void)ptr;
+  return requested;
+#endif
+}
+
+inline void *
+counted_new(std::size_t size)
+{
+  void * ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  const std::size_t bytes = usable_size(ptr, size);
+  ++global_alloc_stats.allocations;
+  global_alloc_stats.bytes += bytes;
+  global_alloc_stats.live_bytes += bytes;
+  return ptr;
+}
+
+inline void
+counted_delete(void * ptr) noexcept
+{
+  if (ptr != nullptr) {
+#if defined(__GLIBC__)
+    global_alloc_stats.live_bytes -= malloc_usable_size(ptr);
+#endif
+    std::free(ptr);
+  }
+}
+
+/// Returns the peak resident set size of the process in KiB, or 0 if unknown.
+inline long
+peak_rss_kib() noexcept
+{
+#if defined(__unix__)
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return usage.ru_maxrss;
+  }
+#endif
+  return 0;
+}
+
+}  // namespace bench
+
+/// Defines replacement global operator new and delete which update bench::global_alloc_stats.
+#define BOUNDED_STRING_BENCH_ALLOC_HOOKS \
+  void * operator new(std::size_t size) { return bench::counted_new(size); } \
+  void * operator new[](std::size_t size) { return bench::counted_new(size); } \
+  void operator delete(void * ptr) noexcept { bench::counted_delete(ptr); } \
+  void operator delete[](void * ptr) noexcept { bench::counted_delete(ptr); } \
+  void operator delete(void * ptr, std::size_t) noexcept { bench::counted_delete(ptr); } \
+  void operator delete[](void * ptr, std::size_t) noexcept { bench::counted_delete(ptr); }
+
+#endif /* BOUNDED_STRING_BENCH_ALLOC_HPP */
@@ -0,0 +1,160 @@
+// Optional hardware performance counters for the BoundedString benchmarks.
+//
+// Counters are read with Linux perf_event_open for the calling thread, user
+// space only. Each counter is opened on its own, so that one which the CPU,
+// kernel or container does not allow is reported as unavailable while the
+// others still work. On other systems every counter is unavailable.
+
+#ifndef BOUNDED_STRING_BENCH_COUNTERS_HPP
+#define BOUNDED_STRING_BENCH_COUNTERS_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench
+{
+
+/// The hardware events a %perf_counters object measures, in report order.
+enum class counter
+{
+  cycles,
+  instructions,
+  l1d_misses,
+  llc_misses,
+  branch_misses,
+};
+
+inline constexpr std::size_t counter_count = 5;
+
+inline constexpr std::array<const char *, counter_count> counter_names = {
+  "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+/// Counter values; NaN where a counter is unavailable.
+using counter_values = std::array<double, counter_count>;
+
+/// A set of per-thread hardware counters which can be started and stopped together.
+class perf_counters
+{
+public:
+  perf_counters() noexcept
+  {
+#if defined(__linux__)
+    constexpr std::uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8U) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+    fds_[0] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds_[1] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds_[2] = open(PERF_TYPE_HW_CACHE, l1d_read_miss);
+    fds_[3] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fds_[4] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+  }
+
+  perf_counters(const perf_counters &) = delete;
+  perf_counters & operator=(const perf_counters &) = delete;
+
+  ~perf_counters() noexcept
+  {
+#if defined(__linux__)
+    for (const int fd : fds_) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  /// Returns true if at least one counter could be opened.
+  bool
+  any_available() const noexcept
+  {
+    for (const int fd : fds_) {
+      if (fd >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Returns true if @a c could be opened.
+  bool
+  available(counter c) const noexcept
+  {
+    return fds_[static_cast<std::size_t>(c)] >= 0;
+  }
+
+  /// Resets and starts every available counter.
+  void
+  start() noexcept
+  {
+#if defined(__linux__)
+    for (const int fd : fds_) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  /// Stops every counter and returns the counts since start().
+  /**
+   * Counts are scaled up by enabled / running time when the kernel had to
+   * multiplex the counters.
+   */
+  counter_values
+  stop() noexcept
+  {
+    counter_values values;
+    values.fill(std::nan(""));
+#if defined(__linux__)
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      if (fds_[i] >= 0) {
+        ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      std::uint64_t data[3] = {};  // value, time enabled, time running
+      if (fds_[i] >= 0 && read(fds_[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)) &&
+        data[2] != 0)
+      {
+        values[i] = static_cast<double>(data[0]) * static_cast<double>(data[1]) /
+          static_cast<double>(data[2]);
+      }
+    }
+#endif
+    return values;
+  }
+
+private:
+#if defined(__linux__)
+  static int
+  open(std::uint32_t type, std::uint64_t config) noexcept
+  {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Fails with EACCES, EPERM or ENOENT in most containers and VMs
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+#endif
+
+  std::array<int, counter_count> fds_ = {-1, -1, -1, -1, -1};
+};
+
+}  // namespace bench
+
+#endif /* BOUNDED_STRING_BENCH_COUNTERS_HPP */
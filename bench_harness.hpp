@@ -0,0 +1,334 @@
+// A minimal microbenchmark harness for the BoundedString benchmarks.
+//
+// Each case is a callable taking an iteration count. The runner grows the
+// count until one run takes at least the minimum time, then times a number
+// of repetitions at that count and reports the median time per operation.
+// With --counters, one more repetition runs under hardware performance
+// counters and their values per operation are reported too. With --alloc,
+// one more repetition counts heap allocations per operation; that needs the
+// hooks from bench_alloc.hpp in the benchmark, or every count reads zero.
+
+#ifndef BOUNDED_STRING_BENCH_HARNESS_HPP
+#define BOUNDED_STRING_BENCH_HARNESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "bench_alloc.hpp"
+#include "bench_counters.hpp"
+
+namespace bench
+{
+
+#if defined(_MSC_VER)
+/// Receives the addresses passed to do_not_optimize, which then escape.
+inline const volatile void * volatile escaped = nullptr;
+#endif
+
+/// Keeps the compiler from discarding the computation of @a value.
+template<
+  typename T
+>
+inline void
+do_not_optimize(const T & value)
+{
+#if defined(_MSC_VER)
+  escaped = &value;
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "m"(value) : "memory");
+#endif
+}
+
+/// Keeps the compiler from caching memory contents across this point.
+inline void
+clobber_memory()
+{
+#if defined(_MSC_VER)
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : : "memory");
+#endif
+}
+
+/// Command line options shared by all cases.
+struct options
+{
+  /// Only cases whose name contains this string run
+  std::string filter;
+  /// Minimum duration of one timed repetition
+  double min_time_ms = 10.0;
+  /// Number of timed repetitions per case
+  unsigned repetitions = 3;
+  /// Whether to read hardware performance counters
+  bool counters = false;
+  /// Whether to count heap allocations
+  bool alloc = false;
+  /// File to write results to as JSON, if not empty
+  std::string json;
+  /// File to write results to as CSV, if not empty
+  std::string csv;
+  /// JSON results of an earlier run to compare against, if not empty
+  std::string baseline;
+  /// Relative slowdown of the median below which a case never counts as regressed
+  double threshold = 0.05;
+  /// Seed for the workload generators
+  std::uint64_t seed = 0x5EED;
+
+  /// Parses the options listed in usage(); exits on anything else.
+  static options
+  parse(int argc, char ** argv)
+  {
+    options opts;
+    for (int i = 1; i < argc; ++i) {
+      const char * arg = argv[i];
+      if (std::strncmp(arg, "--filter=", 9) == 0) {
+        opts.filter = arg + 9;
+      } else if (std::strncmp(arg, "--min-time-ms=", 14) == 0) {
+        opts.min_time_ms = std::strtod(arg + 14, nullptr);
+      } else if (std::strncmp(arg, "--repetitions=", 14) == 0) {
+        opts.repetitions = std::max(1U, static_cast<unsigned>(std::strtoul(arg + 14, nullptr, 10)));
+      } else if (std::strcmp(arg, "--counters") == 0) {
+        opts.counters = true;
+      } else if (std::strcmp(arg, "--alloc") == 0) {
+        opts.alloc = true;
+      } else if (std::strncmp(arg, "--json=", 7) == 0) {
+        opts.json = arg + 7;
+      } else if (std::strncmp(arg, "--csv=", 6) == 0) {
+        opts.csv = arg + 6;
+      } else if (std::strncmp(arg, "--baseline=", 11) == 0) {
+        opts.baseline = arg + 11;
+      } else if (std::strncmp(arg, "--seed=", 7) == 0) {
+        opts.seed = std::strtoull(arg + 7, nullptr, 0);
+      } else if (std::strncmp(arg, "--threshold=", 12) == 0) {
+        opts.threshold = std::strtod(arg + 12, nullptr) / 100.0;
+      } else {
+        usage(argv[0]);
+        std::exit(2);
+      }
+    }
+    return opts;
+  }
+
+  static void
+  usage(const char * program)
+  {
+    std::fprintf(stderr,
+      "usage: %s [--filter=substring] [--min-time-ms=N] [--repetitions=N] [--counters] [--alloc]\n"
+      "       [--json=file] [--csv=file] [--baseline=file.json] [--threshold=percent] [--seed=N]\n", program);
+  }
+};
+
+/// The measurements of one case.
+struct result
+{
+  std::string name;
+  /// Iterations per repetition
+  std::size_t iterations = 0;
+  /// Bytes of string data processed per operation, for throughput
+  double bytes_per_op = 0.0;
+  /// Time per operation of each repetition
+  std::vector<double> samples_ns;
+  /// Median of samples_ns
+  double ns_per_op = 0.0;
+  /// Median absolute deviation of samples_ns
+  double mad_ns = 0.0;
+  /// Hardware counter values per operation, NaN when not measured
+  counter_values counters_per_op = {NAN, NAN, NAN, NAN, NAN};
+  /// Heap allocations per operation, NaN when not measured
+  double allocs_per_op = NAN;
+  /// Heap bytes allocated per operation, NaN when not measured
+  double alloc_bytes_per_op = NAN;
+};
+
+inline double
+median(std::vector<double> values)
+{
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  const std::size_t mid = values.size() / 2;
+  return values.size() % 2 != 0 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+/// Returns the median absolute deviation of @a values from their median.
+inline double
+median_absolute_deviation(const std::vector<double> & values)
+{
+  const double centre = median(values);
+  std::vector<double> deviations;
+  for (const double value : values) {
+    deviations.push_back(value > centre ? value - centre : centre - value);
+  }
+  return median(std::move(deviations));
+}
+
+/// Runs, times and reports benchmark cases.
+class runner
+{
+public:
+  using clock_type = std::chrono::steady_clock;
+
+  explicit
+  runner(options opts)
+  : opts_(std::move(opts))
+  {
+    if (opts_.counters) {
+      counters_ = std::make_unique<perf_counters>();
+      if (!counters_->any_available()) {
+        std::fprintf(stderr, "hardware counters are unavailable; reporting wall time only\n");
+        counters_.reset();
+      }
+    }
+  }
+
+  /// Prints the column headings of the report.
+  void
+  print_header() const
+  {
+    std::printf("%-48s %12s %12s %12s", "case", "ns/op", "Mops/s", "MB/s");
+    if (counters_) {
+      std::printf(" %10s %10s %6s %10s %10s %10s",
+        "cycles/op", "instr/op", "IPC", "L1d-mis/op", "LLC-mis/op", "br-mis/op");
+    }
+    if (opts_.alloc) {
+      std::printf(" %10s %10s", "allocs/op", "bytes/op");
+    }
+    std::printf("\n");
+  }
+
+  /// Times @a fn and prints one report line, unless @a name is filtered out.
+  /**
+   * \param name The case name, conventionally operation/type/bound/workload
+   * \param bytes_per_op The mean number of characters each operation touches
+   * \param fn Callable taking std::size_t iterations which performs that many operations
+   */
+  template<
+    typename Fn
+  >
+  void
+  run(const std::string & name, double bytes_per_op, Fn && fn)
+  {
+    if (!opts_.filter.empty() && name.find(opts_.filter) == std::string::npos) {
+      return;
+    }
+    result res;
+    res.name = name;
+    res.bytes_per_op = bytes_per_op;
+    res.iterations = calibrate(fn);
+    for (unsigned rep = 0; rep < opts_.repetitions; ++rep) {
+      res.samples_ns.push_back(time(fn, res.iterations) / static_cast<double>(res.iterations));
+    }
+    res.ns_per_op = median(res.samples_ns);
+    res.mad_ns = median_absolute_deviation(res.samples_ns);
+    if (counters_) {
+      counters_->start();
+      fn(res.iterations);
+      clobber_memory();
+      res.counters_per_op = counters_->stop();
+      for (double & value : res.counters_per_op) {
+        value /= static_cast<double>(res.iterations);
+      }
+    }
+    if (opts_.alloc) {
+      const alloc_stats before = global_alloc_stats;
+      fn(res.iterations);
+      const alloc_stats after = global_alloc_stats;
+      res.allocs_per_op = static_cast<double>(after.allocations - before.allocations) /
+        static_cast<double>(res.iterations);
+      res.alloc_bytes_per_op = static_cast<double>(after.bytes - before.bytes) /
+        static_cast<double>(res.iterations);
+    }
+    report(res);
+    results_.push_back(std::move(res));
+  }
+
+  const options &
+  opts() const noexcept
+  {
+    return opts_;
+  }
+
+  const std::vector<result> &
+  results() const noexcept
+  {
+    return results_;
+  }
+
+private:
+  template<
+    typename Fn
+  >
+  static double
+  time(Fn & fn, std::size_t iterations)
+  {
+    const auto start = clock_type::now();
+    fn(iterations);
+    clobber_memory();
+    return std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+  }
+
+  template<
+    typename Fn
+  >
+  std::size_t
+  calibrate(Fn & fn) const
+  {
+    const double target_ns = opts_.min_time_ms * 1e6;
+    std::size_t iterations = 1;
+    for (;;) {
+      const double elapsed = time(fn, iterations);
+      if (elapsed >= target_ns) {
+        return iterations;
+      }
+      // Aim a little past the target, growing at most 100x per step
+      const double scale = elapsed > 0 ? std::min(100.0, 1.2 * target_ns / elapsed) : 100.0;
+      iterations = std::max(iterations + 1, static_cast<std::size_t>(static_cast<double>(iterations) * scale));
+    }
+  }
+
+  void
+  report(const result & res) const
+  {
+    const double ops_per_sec = res.ns_per_op > 0 ? 1e9 / res.ns_per_op : 0.0;
+    std::printf("%-48s %12.2f %12.2f %12.1f", res.name.c_str(), res.ns_per_op,
+      ops_per_sec / 1e6, ops_per_sec * res.bytes_per_op / 1e6);
+    if (counters_) {
+      // printf renders unavailable counters (NaN) as "nan"
+      const auto & c = res.counters_per_op;
+      const double ipc = c[static_cast<std::size_t>(counter::instructions)] /
+        c[static_cast<std::size_t>(counter::cycles)];
+      std::printf(" %10.1f %10.1f %6.2f %10.3f %10.3f %10.3f",
+        c[static_cast<std::size_t>(counter::cycles)], c[static_cast<std::size_t>(counter::instructions)],
+        ipc, c[static_cast<std::size_t>(counter::l1d_misses)],
+        c[static_cast<std::size_t>(counter::llc_misses)], c[static_cast<std::size_t>(counter::branch_misses)]);
+    }
+    if (opts_.alloc) {
+      std::printf(" %10.2f %10.1f", res.allocs_per_op, res.alloc_bytes_per_op);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+  }
+
+  options opts_;
+  std::unique_ptr<perf_counters> counters_;
+  std::vector<result> results_;
+};
+
+}  // namespace bench
+
+#endif /* BOUNDED_STRING_BENCH_HARNESS_HPP */
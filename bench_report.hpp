@@ -0,0 +1,244 @@
+// Machine-readable output and baseline comparison for the BoundedString benchmarks.
+//
+// Results are written as JSON (one object per case) or CSV. A JSON file from
+// an earlier run can be loaded as a baseline: a case regresses when its
+// median time per operation grows by more than the threshold and by more than
+// the noise of both runs, estimated from their median absolute deviations.
+
+#ifndef BOUNDED_STRING_BENCH_REPORT_HPP
+#define BOUNDED_STRING_BENCH_REPORT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_harness.hpp"
+
+namespace bench
+{
+
+/// Noise allowance, in MADs scaled to standard deviations, before a change counts.
+inline constexpr double noise_sigmas = 3.0;
+/// Scales a MAD to the standard deviation of normally distributed samples.
+inline constexpr double mad_to_sigma = 1.4826;
+
+/// The baseline figures of one case.
+struct baseline_entry
+{
+  double ns_per_op = 0.0;
+  double mad_ns = 0.0;
+};
+
+inline void
+write_json_string(std::FILE * out, const std::string & text)
+{
+  std::fputc('"', out);
+  for (const char ch : text) {
+    if (ch == '"' || ch == '\\') {
+      std::fputc('\\', out);
+    }
+    std::fputc(ch, out);
+  }
+  std::fputc('"', out);
+}
+
+inline void
+write_json_number(std::FILE * out, double value)
+{
+  if (std::isnan(value)) {
+    std::fputs("null", out);
+  } else {
+    std::fprintf(out, "%.6g", value);
+  }
+}
+
+/// Writes every result of @a r to @a path as JSON.
+inline bool
+write_json(const std::string & path, const runner & r)
+{
+  std::FILE * out = std::fopen(path.c_str(), "w");
+  if (out == nullptr) {
+    return false;
+  }
+  std::fprintf(out, "{\n  \"repetitions\": %u,\n  \"min_time_ms\": %g,\n  \"cases\": [",
+    r.opts().repetitions, r.opts().min_time_ms);
+  const char * separator = "\n";
+  for (const result & res : r.results()) {
+    std::fprintf(out, "%s    {\"name\": ", separator);
+    write_json_string(out, res.name);
+    std::fprintf(out, ", \"iterations\": %zu, \"bytes_per_op\": ", res.iterations);
+    write_json_number(out, res.bytes_per_op);
+    std::fputs(", \"ns_per_op\": ", out);
+    write_json_number(out, res.ns_per_op);
+    std::fputs(", \"mad_ns\": ", out);
+    write_json_number(out, res.mad_ns);
+    std::fputs(", \"samples_ns\": [", out);
+    for (std::size_t i = 0; i < res.samples_ns.size(); ++i) {
+      std::fputs(i == 0 ? "" : ", ", out);
+      write_json_number(out, res.samples_ns[i]);
+    }
+    std::fputs("]", out);
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      std::fprintf(out, ", \"%s_per_op\": ", counter_names[i]);
+      write_json_number(out, res.counters_per_op[i]);
+    }
+    std::fputs(", \"allocs_per_op\": ", out);
+    write_json_number(out, res.allocs_per_op);
+    std::fputs(", \"alloc_bytes_per_op\": ", out);
+    write_json_number(out, res.alloc_bytes_per_op);
+    std::fputs("}", out);
+    separator = ",\n";
+  }
+  std::fputs("\n  ]\n}\n", out);
+  return std::fclose(out) == 0;
+}
+
+/// Writes every result of @a r to @a path as CSV with a header row.
+inline bool
+write_csv(const std::string & path, const runner & r)
+{
+  std::FILE * out = std::fopen(path.c_str(), "w");
+  if (out == nullptr) {
+    return false;
+  }
+  std::fputs("name,iterations,bytes_per_op,ns_per_op,mad_ns,min_ns,max_ns", out);
+  for (const char * name : counter_names) {
+    std::fprintf(out, ",%s_per_op", name);
+  }
+  std::fputs(",allocs_per_op,alloc_bytes_per_op\n", out);
+  for (const result & res : r.results()) {
+    double lo = res.ns_per_op;
+    double hi = res.ns_per_op;
+    for (const double sample : res.samples_ns) {
+      lo = std::min(lo, sample);
+      hi = std::max(hi, sample);
+    }
+    // Case names never contain commas or quotes
+    std::fprintf(out, "%s,%zu,%g,%g,%g,%g,%g", res.name.c_str(), res.iterations, res.bytes_per_op,
+      res.ns_per_op, res.mad_ns, lo, hi);
+    const auto write_optional = [out](double value) {
+      if (std::isnan(value)) {
+        std::fputc(',', out);
+      } else {
+        std::fprintf(out, ",%g", value);
+      }
+    };
+    for (const double value : res.counters_per_op) {
+      write_optional(value);
+    }
+    write_optional(res.allocs_per_op);
+    write_optional(res.alloc_bytes_per_op);
+    std::fputc('\n', out);
+  }
+  return std::fclose(out) == 0;
+}
+
+/// Reads the name, ns_per_op and mad_ns of each case from JSON written by write_json().
+inline bool
+load_baseline(const std::string & path, std::unordered_map<std::string, baseline_entry> & out)
+{
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  const auto number_after = [&text](const char * key, std::size_t from, std::size_t to) {
+    const std::size_t at = text.find(key, from);
+    if (at == std::string::npos || at >= to) {
+      return 0.0;
+    }
+    return std::strtod(text.c_str() + text.find(':', at) + 1, nullptr);
+  };
+  std::size_t pos = text.find("\"name\"");
+  while (pos != std::string::npos) {
+    const std::size_t next = text.find("\"name\"", pos + 1);
+    const std::size_t end = next == std::string::npos ? text.size() : next;
+    std::string name;
+    for (std::size_t i = text.find('"', text.find(':', pos)) + 1; i < end && text[i] != '"'; ++i) {
+      if (text[i] == '\\') {
+        ++i;
+      }
+      name += text[i];
+    }
+    out[name] = baseline_entry{number_after("\"ns_per_op\"", pos, end), number_after("\"mad_ns\"", pos, end)};
+    pos = next;
+  }
+  return true;
+}
+
+/// Prints the cases of @a r which differ significantly from @a baseline.
+/**
+ * \return The number of regressed cases
+ */
+inline std::size_t
+compare_to_baseline(
+  const runner & r,
+  const std::unordered_map<std::string, baseline_entry> & baseline)
+{
+  std::size_t compared = 0;
+  std::size_t regressed = 0;
+  std::size_t improved = 0;
+  std::printf("\n%-48s %12s %12s %9s %s\n", "case", "base ns/op", "ns/op", "change", "verdict");
+  for (const result & res : r.results()) {
+    const auto found = baseline.find(res.name);
+    if (found == baseline.end() || found->second.ns_per_op <= 0.0) {
+      continue;
+    }
+    ++compared;
+    const baseline_entry & base = found->second;
+    const double delta = res.ns_per_op - base.ns_per_op;
+    const double noise = noise_sigmas * mad_to_sigma * (res.mad_ns + base.mad_ns);
+    const bool significant = std::abs(delta) > r.opts().threshold * base.ns_per_op && std::abs(delta) > noise;
+    if (!significant) {
+      continue;
+    }
+    const bool slower = delta > 0;
+    (slower ? regressed : improved) += 1;
+    std::printf("%-48s %12.2f %12.2f %+8.1f%% %s\n", res.name.c_str(), base.ns_per_op, res.ns_per_op,
+      100.0 * delta / base.ns_per_op, slower ? "REGRESSED" : "improved");
+  }
+  std::printf("%zu of %zu cases compared with the baseline: %zu regressed, %zu improved\n",
+    compared, r.results().size(), regressed, improved);
+  return regressed;
+}
+
+/// Writes the requested output files and compares with the baseline, if any.
+/**
+ * \return The process exit status: 0 on success, 1 if any case regressed
+ *         and 2 if a file could not be read or written
+ */
+inline int
+finish(const runner & r)
+{
+  const options & opts = r.opts();
+  if (!opts.json.empty() && !write_json(opts.json, r)) {
+    std::fprintf(stderr, "cannot write %s\n", opts.json.c_str());
+    return 2;
+  }
+  if (!opts.csv.empty() && !write_csv(opts.csv, r)) {
+    std::fprintf(stderr, "cannot write %s\n", opts.csv.c_str());
+    return 2;
+  }
+  if (!opts.baseline.empty()) {
+    std::unordered_map<std::string, baseline_entry> baseline;
+    if (!load_baseline(opts.baseline, baseline)) {
+      std::fprintf(stderr, "cannot read %s\n", opts.baseline.c_str());
+      return 2;
+    }
+    if (compare_to_baseline(r, baseline) != 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace bench
+
+#endif /* BOUNDED_STRING_BENCH_REPORT_HPP */
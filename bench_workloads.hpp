@@ -0,0 +1,273 @@
+// Workload generators for the BoundedString benchmarks.
+//
+// Each workload produces strings shaped like a kind of production data and
+// never longer than a given bound; longer values are truncated, as they would
+// be when stored in a bounded field. Generation uses its own splitmix64
+// generator rather than <random> distributions, so a seed yields the same
+// strings with every standard library.
+
+#ifndef BOUNDED_STRING_BENCH_WORKLOADS_HPP
+#define BOUNDED_STRING_BENCH_WORKLOADS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+enum class workload
+{
+  /// Lowercase letters, lengths uniform over [0, bound]
+  uniform,
+  /// Lowercase letters, lengths mostly under a quarter of the bound, sometimes the whole bound
+  short_biased,
+  /// Lowercase letters, lengths Zipf-distributed over [1, bound]
+  zipf,
+  /// Dotted identifiers which share a few long prefixes and differ in a numeric suffix
+  prefixed,
+  /// Access-log lines with a timestamp, level, thread, request path, status and duration
+  log_lines,
+  /// Integers, decimals and numbers in scientific notation
+  numeric,
+  /// Exchange ticker symbols, some with a market suffix
+  tickers,
+  /// Words mixing ASCII with 2-, 3- and 4-byte UTF-8 sequences, never split inside a sequence
+  utf8_text,
+};
+
+inline constexpr std::array<workload, 8> all_workloads = {
+  workload::uniform, workload::short_biased, workload::zipf, workload::prefixed,
+  workload::log_lines, workload::numeric, workload::tickers, workload::utf8_text};
+
+inline const char *
+workload_name(workload w)
+{
+  switch (w) {
+    case workload::uniform: return "uniform";
+    case workload::short_biased: return "short";
+    case workload::zipf: return "zipf";
+    case workload::prefixed: return "prefixed";
+    case workload::log_lines: return "log";
+    case workload::numeric: return "numeric";
+    case workload::tickers: return "ticker";
+    case workload::utf8_text: return "utf8";
+  }
+  return "?";
+}
+
+/// A small, fast generator whose output is fixed by its seed on every platform.
+class splitmix64
+{
+public:
+  explicit
+  splitmix64(std::uint64_t seed) noexcept
+  : state_(seed)
+  {}
+
+  std::uint64_t
+  next() noexcept
+  {
+    std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31U);
+  }
+
+  /// Returns a number in [0, @a n); @a n must not be zero.
+  std::size_t
+  below(std::size_t n) noexcept
+  {
+    return static_cast<std::size_t>(next() % n);
+  }
+
+  /// Returns a number in [0, 1).
+  double
+  unit() noexcept
+  {
+    return static_cast<double>(next() >> 11U) * 0x1.0p-53;
+  }
+
+private:
+  std::uint64_t state_;
+};
+
+namespace workload_detail
+{
+
+inline std::string
+letters(splitmix64 & rng, std::size_t length)
+{
+  std::string s(length, ' ');
+  for (char & ch : s) {
+    ch = static_cast<char>('a' + rng.below(26));
+  }
+  return s;
+}
+
+inline std::size_t
+zipf_length(splitmix64 & rng, const std::vector<double> & cdf)
+{
+  const auto it = std::lower_bound(cdf.begin(), cdf.end(), rng.unit() * cdf.back());
+  return static_cast<std::size_t>(it - cdf.begin()) + 1;
+}
+
+inline std::string
+prefixed(splitmix64 & rng, std::size_t bound)
+{
+  static constexpr std::array<std::string_view, 4> prefixes = {
+    "com.example.payments.settlement.", "com.example.orders.fulfilment.",
+    "org.acme.telemetry.cpu.", "net.corp.eu-west-1.frontend."};
+  // The shared part takes about two thirds of the bound, so that strings
+  // differ only towards the end whatever the bound is
+  const std::string_view prefix = prefixes[rng.below(prefixes.size())];
+  std::string s(prefix.substr(0, std::max<std::size_t>(1, bound * 2 / 3)));
+  char suffix[32];
+  std::snprintf(suffix, sizeof(suffix), "node-%06zu.requests", rng.below(1000000));
+  s += suffix;
+  return s;
+}
+
+inline std::string
+log_line(splitmix64 & rng)
+{
+  static constexpr std::array<const char *, 4> levels = {"INFO ", "INFO ", "WARN ", "ERROR"};
+  static constexpr std::array<const char *, 5> paths = {
+    "/api/v1/orders/", "/api/v1/users/", "/health?probe=", "/api/v2/quotes/", "/static/app.js?v="};
+  static constexpr std::array<int, 5> statuses = {200, 200, 201, 404, 500};
+  // Draw in a fixed order; the evaluation order of function arguments is unspecified
+  std::array<std::size_t, 11> draws = {};
+  const std::array<std::size_t, 11> ranges = {
+    28, 24, 60, 60, 1000, levels.size(), 16, paths.size(), 10000000, statuses.size(), 2000};
+  for (std::size_t i = 0; i < draws.size(); ++i) {
+    draws[i] = rng.below(ranges[i]);
+  }
+  char line[256];
+  const int written = std::snprintf(line, sizeof(line),
+    "2026-10-%02zuT%02zu:%02zu:%02zu.%03zuZ %s [worker-%zu] GET %s%zu %d %zums",
+    1 + draws[0], draws[1], draws[2], draws[3], draws[4], levels[draws[5]], draws[6],
+    paths[draws[7]], draws[8], statuses[draws[9]], draws[10]);
+  return std::string(line, static_cast<std::size_t>(std::max(0, written)));
+}
+
+inline std::string
+numeric(splitmix64 & rng)
+{
+  char field[64];
+  int written = 0;
+  switch (rng.below(3)) {
+    case 0: {
+      const auto magnitude = static_cast<long long>(rng.next() % 10000000000ULL);
+      const long long sign = rng.below(4) == 0 ? -1 : 1;
+      written = std::snprintf(field, sizeof(field), "%lld", sign * magnitude);
+      break;
+    }
+    case 1: {
+      const auto decimals = static_cast<int>(1 + rng.below(6));
+      const double mantissa = rng.unit();
+      const double scale = std::pow(10.0, static_cast<double>(rng.below(7)));
+      written = std::snprintf(field, sizeof(field), "%.*f", decimals, mantissa * scale);
+      break;
+    }
+    default: {
+      const double mantissa = rng.unit() - 0.5;
+      const double scale = std::pow(10.0, static_cast<double>(rng.below(40)) - 20.0);
+      written = std::snprintf(field, sizeof(field), "%.6e", mantissa * scale);
+      break;
+    }
+  }
+  return std::string(field, static_cast<std::size_t>(std::max(0, written)));
+}
+
+inline std::string
+ticker(splitmix64 & rng)
+{
+  static constexpr std::array<std::string_view, 4> markets = {".L", ".TO", ".PA", ".DE"};
+  std::string s(1 + rng.below(5), ' ');
+  for (char & ch : s) {
+    ch = static_cast<char>('A' + rng.below(26));
+  }
+  if (rng.below(5) == 0) {
+    s += markets[rng.below(markets.size())];
+  }
+  return s;
+}
+
+inline std::string
+utf8_text(splitmix64 & rng, std::size_t bound)
+{
+  static constexpr std::array<std::string_view, 14> words = {
+    "the", "order", "shipped", "naïve", "café", "straße", "Ελληνικά", "русский",
+    "日本語", "中文", "한국어", "😀", "🚀", "ok"};
+  const auto target = static_cast<std::size_t>(rng.unit() * static_cast<double>(bound + 1));
+  std::string s;
+  for (;;) {
+    const std::string_view word = words[rng.below(words.size())];
+    const std::size_t extra = word.size() + (s.empty() ? 0 : 1);
+    if (s.size() + extra > std::min(target, bound)) {
+      return s;
+    }
+    if (!s.empty()) {
+      s += ' ';
+    }
+    s += word;
+  }
+}
+
+}  // namespace workload_detail
+
+/// Generates @a count strings of workload @a w, none longer than @a bound characters.
+/**
+ * The strings depend only on @a w, @a bound, @a count and @a seed.
+ */
+inline std::vector<std::string>
+generate(workload w, std::size_t bound, std::size_t count, std::uint64_t seed)
+{
+  splitmix64 rng(seed ^ (static_cast<std::uint64_t>(w) << 56U) ^ (bound * 0x9E3779B97F4A7C15ULL));
+  std::vector<double> zipf_cdf;
+  if (w == workload::zipf) {
+    double total = 0.0;
+    for (std::size_t k = 1; k <= bound; ++k) {
+      total += 1.0 / std::pow(static_cast<double>(k), 1.1);
+      zipf_cdf.push_back(total);
+    }
+  }
+  std::vector<std::string> strings;
+  strings.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    std::string s;
+    switch (w) {
+      case workload::uniform:
+        s = workload_detail::letters(rng, rng.below(bound + 1));
+        break;
+      case workload::short_biased: {
+        const double u = rng.unit();
+        const double fraction = u < 0.6 ? 0.25 * rng.unit() : u < 0.95 ? 0.25 + 0.5 * rng.unit() : 1.0;
+        s = workload_detail::letters(rng, static_cast<std::size_t>(fraction * static_cast<double>(bound)));
+        break;
+      }
+      case workload::zipf: s = workload_detail::letters(rng, workload_detail::zipf_length(rng, zipf_cdf)); break;
+      case workload::prefixed: s = workload_detail::prefixed(rng, bound); break;
+      case workload::log_lines: s = workload_detail::log_line(rng); break;
+      case workload::numeric: s = workload_detail::numeric(rng); break;
+      case workload::tickers: s = workload_detail::ticker(rng); break;
+      case workload::utf8_text: s = workload_detail::utf8_text(rng, bound); break;
+    }
+    if (s.size() > bound) {
+      s.resize(bound);
+    }
+    strings.push_back(std::move(s));
+  }
+  return strings;
+}
+
+}  // namespace bench
+
+#endif /* BOUNDED_STRING_BENCH_WORKLOADS_HPP */
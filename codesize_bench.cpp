@@ -0,0 +1,171 @@
+// Compile time and code size of many distinct bounds in one binary.
+//
+// Usage: BoundedString_codesize_bench [--cxx=compiler] [--flags="compiler flags"]
+//                                     [--type=bounded|inline] [count...]
+//
+// For each count N (default 10, 100 and 1000) a translation unit is generated
+// which explicitly instantiates the string type, every member included, for
+// the bounds 1 to N. It is compiled with the compiler which built this
+// benchmark, and the wall-clock compile time, object file size and total size
+// of the .text sections are reported, in total and per instantiation over a
+// translation unit which only includes the headers. Without --type both
+// bounded_basic_string and inline_bounded_basic_string are measured.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+#ifndef BOUNDED_STRING_CXX
+#define BOUNDED_STRING_CXX "c++"
+#endif
+
+#ifndef BOUNDED_STRING_INCLUDE_DIR
+#define BOUNDED_STRING_INCLUDE_DIR "."
+#endif
+
+namespace {
+
+struct measurement
+{
+  double seconds = 0.0;
+  std::uintmax_t object_bytes = 0;
+  /// Total size of sections named .text*, or -1 if the object is not ELF64
+  long long text_bytes = -1;
+};
+
+std::uint64_t
+read_le(const std::vector<unsigned char> & data, std::size_t offset, std::size_t width)
+{
+  std::uint64_t value = 0;
+  for (std::size_t i = 0; i < width && offset + i < data.size(); ++i) {
+    value |= static_cast<std::uint64_t>(data[offset + i]) << (8U * i);
+  }
+  return value;
+}
+
+/// Sums the sizes of the .text sections of a little-endian ELF64 object.
+long long
+text_size(const std::filesystem::path & object)
+{
+  std::ifstream in(object, std::ios::binary);
+  const std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (data.size() < 64 || std::memcmp(data.data(), "\x7f" "ELF", 4) != 0 || data[4] != 2 || data[5] != 1) {
+    return -1;
+  }
+  const std::uint64_t section_offset = read_le(data, 0x28, 8);
+  const std::uint64_t entry_size = read_le(data, 0x3A, 2);
+  const std::uint64_t count = read_le(data, 0x3C, 2);
+  const std::uint64_t names_index = read_le(data, 0x3E, 2);
+  const std::uint64_t names_offset = read_le(data, section_offset + names_index * entry_size + 0x18, 8);
+  long long total = 0;
+  for (std::uint64_t i = 0; i < count; ++i) {
+    const std::uint64_t header = section_offset + i * entry_size;
+    const std::uint64_t name = names_offset + read_le(data, header, 4);
+    if (name + 5 <= data.size() && std::memcmp(data.data() + name, ".text", 5) == 0) {
+      total += static_cast<long long>(read_le(data, header + 0x20, 8));
+    }
+  }
+  return total;
+}
+
+measurement
+compile(
+  const std::string & cxx,
+  const std::string & flags,
+  const std::string & type,
+  std::size_t count,
+  const std::filesystem::path & dir)
+{
+  const std::filesystem::path source = dir / ("instantiate_" + std::to_string(count) + ".cpp");
+  const std::filesystem::path object = dir / ("instantiate_" + std::to_string(count) + ".o");
+  {
+    std::ofstream out(source);
+    out << "#include \"BoundedString.hpp\"\n#include \"InlineBoundedString.hpp\"\n";
+    for (std::size_t bound = 1; bound <= count; ++bound) {
+      out << "template class " << type << "<char, " << bound << ">;\n";
+    }
+  }
+  const std::string command = cxx + " " + flags + " -I\"" BOUNDED_STRING_INCLUDE_DIR "\" -c \"" +
+    source.string() + "\" -o \"" + object.string() + "\"";
+  const auto start = std::chrono::steady_clock::now();
+  if (std::system(command.c_str()) != 0) {
+    std::fprintf(stderr, "compile failed: %s\n", command.c_str());
+    std::exit(1);
+  }
+  measurement m;
+  m.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  m.object_bytes = std::filesystem::file_size(object);
+  m.text_bytes = text_size(object);
+  return m;
+}
+
+}  // namespace
+
+int
+main(int argc, char ** argv)
+{
+  std::string cxx = BOUNDED_STRING_CXX;
+  std::string flags = "-std=c++17 -O2";
+  std::vector<std::string> types = {"bounded_basic_string", "inline_bounded_basic_string"};
+  std::vector<std::size_t> counts;
+  for (int i = 1; i < argc; ++i) {
+    const char * arg = argv[i];
+    if (std::strncmp(arg, "--cxx=", 6) == 0) {
+      cxx = arg + 6;
+    } else if (std::strncmp(arg, "--flags=", 8) == 0) {
+      flags = arg + 8;
+    } else if (std::strcmp(arg, "--type=bounded") == 0) {
+      types = {"bounded_basic_string"};
+    } else if (std::strcmp(arg, "--type=inline") == 0) {
+      types = {"inline_bounded_basic_string"};
+    } else if (arg[0] >= '1' && arg[0] <= '9') {
+      counts.push_back(std::strtoull(arg, nullptr, 10));
+    } else {
+      std::fprintf(stderr,
+        "usage: %s [--cxx=compiler] [--flags=\"compiler flags\"] [--type=bounded|inline] [count...]\n",
+        argv[0]);
+      return 2;
+    }
+  }
+  if (counts.empty()) {
+    counts = {10, 100, 1000};
+  }
+
+  long long pid = 0;
+#if defined(__unix__)
+  pid = static_cast<long long>(getpid());
+#endif
+  const std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / ("bounded_string_codesize_" + std::to_string(pid));
+  std::filesystem::create_directories(dir);
+
+  std::printf("compiler: %s %s\n", cxx.c_str(), flags.c_str());
+  std::printf("%-28s %6s %10s %12s %12s %14s %14s %14s\n", "type", "bounds", "compile s",
+    "object B", ".text B", "ms/instance", "object B/inst", ".text B/inst");
+  for (const std::string & type : types) {
+    const measurement empty = compile(cxx, flags, type, 0, dir);
+    for (const std::size_t count : counts) {
+      const measurement m = compile(cxx, flags, type, count, dir);
+      const auto n = static_cast<double>(count);
+      std::printf("%-28s %6zu %10.2f %12ju %12lld %14.2f %14.0f %14.0f\n", type.c_str(), count, m.seconds,
+        m.object_bytes, m.text_bytes, 1e3 * (m.seconds - empty.seconds) / n,
+        (static_cast<double>(m.object_bytes) - static_cast<double>(empty.object_bytes)) / n,
+        m.text_bytes < 0 ? 0.0 : static_cast<double>(m.text_bytes - empty.text_bytes) / n);
+      std::fflush(stdout);
+    }
+  }
+  std::filesystem::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,112 @@
+// Cost of default-constructing the bounded string types.
+//
+// Usage: BoundedString_default_ctor_bench [--filter=substring] [--min-time-ms=N]
+//                                         [--repetitions=N] [--json=file] [--csv=file]
+//
+// Each case default-constructs objects over and over in the same storage,
+// and zero_init/type/bound value-initialises storage of the size of that type
+// the same way, which is the least any constructor must do. The objects are
+// not destroyed: a default-constructed string owns no memory, and timing the
+// destructor would measure something else. The program checks that the default
+// constructor of bounded_basic_string, whose diagnostics hooks are empty by
+// default, costs no more than zero-initialising an object of its size, and
+// exits with status 1 if it does. inline_bounded_basic_string and
+// std::string are reported for comparison.
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <new>
+#include <string>
+
+#include "BoundedString.hpp"
+#include "InlineBoundedString.hpp"
+#include "bench_harness.hpp"
+#include "bench_report.hpp"
+
+namespace {
+
+template<
+  typename T
+>
+void
+construct(std::size_t iterations)
+{
+  alignas(T) unsigned char storage[sizeof(T)];
+  for (std::size_t i = 0; i < iterations; ++i) {
+    bench::do_not_optimize(*::new (static_cast<void *>(storage)) T());
+  }
+}
+
+template<
+  std::size_t Bytes
+>
+void
+zero_init(std::size_t iterations)
+{
+  using storage_type = std::array<unsigned char, Bytes>;
+  alignas(std::max_align_t) unsigned char storage[Bytes];
+  for (std::size_t i = 0; i < iterations; ++i) {
+    bench::do_not_optimize(*::new (static_cast<void *>(storage)) storage_type{});
+  }
+}
+
+const bench::result *
+find_result(const bench::runner & r, const std::string & name)
+{
+  for (const bench::result & res : r.results()) {
+    if (res.name == name) {
+      return &res;
+    }
+  }
+  return nullptr;
+}
+
+/// Checks that @a name costs no more than @a baseline, allowing for noise and one cycle of skew.
+bool
+as_cheap_as(const bench::runner & r, const std::string & name, const std::string & baseline)
+{
+  const bench::result * res = find_result(r, name);
+  const bench::result * base = find_result(r, baseline);
+  if (res == nullptr || base == nullptr) {
+    return true;
+  }
+  const double allowed = base->ns_per_op * (1.0 + r.opts().threshold) +
+    bench::noise_sigmas * bench::mad_to_sigma * (res->mad_ns + base->mad_ns) + 0.5;
+  const bool ok = res->ns_per_op <= allowed;
+  std::printf("%-48s %8.2f ns vs %-24s %8.2f ns: %s\n", name.c_str(), res->ns_per_op, baseline.c_str(),
+    base->ns_per_op, ok ? "ok" : "SLOWER");
+  return ok;
+}
+
+template<
+  std::size_t Bound
+>
+bool
+run_bound(bench::runner & r)
+{
+  using bounded = bounded_basic_string<char, Bound>;
+  using inlined = inline_bounded_basic_string<char, Bound>;
+  const std::string bound = std::to_string(Bound);
+  r.run("zero_init/bounded/" + bound, sizeof(bounded), &zero_init<sizeof(bounded)>);
+  r.run("default_ctor/bounded/" + bound, 0.0, &construct<bounded>);
+  r.run("zero_init/inline/" + bound, sizeof(inlined), &zero_init<sizeof(inlined)>);
+  r.run("default_ctor/inline/" + bound, 0.0, &construct<inlined>);
+  return as_cheap_as(r, "default_ctor/bounded/" + bound, "zero_init/bounded/" + bound);
+}
+
+}  // namespace
+
+int
+main(int argc, char ** argv)
+{
+  bench::runner r(bench::options::parse(argc, argv));
+  r.print_header();
+  r.run("default_ctor/std::string", 0.0, &construct<std::string>);
+  bool ok = true;
+  ok = run_bound<16>(r) && ok;
+  ok = run_bound<256>(r) && ok;
+  ok = run_bound<4096>(r) && ok;
+  const int status = bench::finish(r);
+  return status != 0 ? status : ok ? 0 : 1;
+}
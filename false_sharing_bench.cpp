@@ -0,0 +1,82 @@
+// Cost of false sharing between per-thread bounded strings.
+//
+// Usage: BoundedString_false_sharing_bench [writes-per-thread]
+//
+// Every thread repeatedly overwrites its own small bounded string. In the
+// packed layout neighbouring threads' strings share cache lines; in the
+// padded layouts (aligned_bounded_string and per_thread_array) they do not.
+// per_thread_array is measured both indexed by thread number and through
+// local(), which each thread calls before every write.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "AlignedBoundedString.hpp"
+#include "InlineBoundedString.hpp"
+
+namespace {
+
+constexpr std::size_t bound = 15;
+constexpr std::string_view symbols[] = {"AAPL", "MSFT", "GOOG", "AMZN"};
+
+template<
+  typename Get
+>
+double
+run(unsigned threads, std::size_t writes, Get && get)
+{
+  std::vector<std::thread> workers;
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([t, writes, &get] {
+      for (std::size_t i = 0; i < writes; ++i) {
+        auto & str = get(t);
+        str.assign(symbols[i % 4]);
+        // Keep the stores from being collapsed into one
+#if defined(_MSC_VER)
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r"(str.data()) : "memory");
+#endif
+      }
+    });
+  }
+  for (auto & worker : workers) {
+    worker.join();
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / static_cast<double>(writes);
+}
+
+}  // namespace
+
+int
+main(int argc, char ** argv)
+{
+  const std::size_t writes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  std::printf("sizeof: packed %zu, aligned %zu\n",
+    sizeof(inline_bounded_string<bound>), sizeof(aligned_bounded_string<bound>));
+  std::printf("%7s %14s %14s %14s %14s %14s\n",
+    "threads", "packed ns/op", "aligned64", "aligned128", "per_thread", "local()");
+  for (const unsigned threads : {1U, 2U, 4U, 8U}) {
+    std::vector<inline_bounded_string<bound>> packed(threads);
+    std::vector<aligned_bounded_string<bound>> aligned(threads);
+    std::vector<aligned_bounded_string<bound, 128>> aligned128(threads);
+    per_thread_array<inline_bounded_string<bound>> per_thread(threads);
+    std::printf("%7u %14.2f %14.2f %14.2f %14.2f %14.2f\n", threads,
+      run(threads, writes, [&](unsigned t) -> auto & { return packed[t]; }),
+      run(threads, writes, [&](unsigned t) -> auto & { return aligned[t]; }),
+      run(threads, writes, [&](unsigned t) -> auto & { return aligned128[t]; }),
+      run(threads, writes, [&](unsigned t) -> auto & { return per_thread[t]; }),
+      run(threads, writes, [&](unsigned) -> auto & { return per_thread.local(); }));
+  }
+  return 0;
+}
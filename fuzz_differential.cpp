@@ -0,0 +1,497 @@
+// Differential fuzzing of the bounded string types against std::string.
+//
+// Each input is decoded into a sequence of operations (assign, operator=,
+// insert, including from a single-pass range, push_back, erase, pop_back, clear, trim, the find family, compare,
+// substr, at and copy) which is applied to bounded_basic_string and
+// inline_bounded_basic_string for several bounds, and to a std::string
+// holding the expected contents. After every operation the contents and
+// results must match, an operation must throw std::length_error exactly when
+// its result would exceed the bound, and a string must be unchanged when an
+// operation throws. Any difference aborts.
+//
+// Built with clang's -fsanitize=fuzzer (-DBUILD_FUZZ=ON) this is a libFuzzer
+// target. Otherwise it is a replay program:
+//
+// Usage: BoundedString_fuzz_replay [file-or-directory...]
+//
+// replays each file, or every file in each directory (such as a libFuzzer
+// corpus), as one input. Without arguments it replays a fixed set of inputs
+// generated from constant seeds, which is how it runs as a test.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BoundedString.hpp"
+#include "InlineBoundedString.hpp"
+
+namespace {
+
+#define FUZZ_REQUIRE(condition) \
+  do { \
+    if (!(condition)) { \
+      std::fprintf(stderr, "%s:%d: %s failed (%s, operation %u)\n", __FILE__, __LINE__, #condition, \
+        type_name, static_cast<unsigned>(op)); \
+      std::abort(); \
+    } \
+  } while (false)
+
+/// Decodes operation arguments from the fuzzer's bytes; reads past the end return 0.
+class reader
+{
+public:
+  reader(const std::uint8_t * data, std::size_t size) noexcept
+  : data_(data),
+    size_(size)
+  {}
+
+  bool
+  done() const noexcept
+  {
+    return pos_ >= size_;
+  }
+
+  std::uint8_t
+  byte() noexcept
+  {
+    return pos_ < size_ ? data_[pos_++] : 0;
+  }
+
+  /// A position in [0, @a limit + 1], or npos; @a limit + 1 is out of range.
+  std::size_t
+  position(std::size_t limit) noexcept
+  {
+    const std::uint8_t b = byte();
+    return b == 0xFF ? std::string::npos : b % (limit + 2);
+  }
+
+  /// A character from a small alphabet, so that searches find something.
+  char
+  character() noexcept
+  {
+    static constexpr char alphabet[] = {'a', 'b', 'c', 'x', 'y', 'z', ' ', '\0'};
+    return alphabet[byte() % sizeof(alphabet)];
+  }
+
+  /// Up to 80 characters, longer than the largest bound tried.
+  std::string
+  text(bool allow_nul = true)
+  {
+    std::string s(byte() % 81, ' ');
+    for (char & ch : s) {
+      ch = character();
+      if (ch == '\0' && !allow_nul) {
+        ch = 'n';
+      }
+    }
+    return s;
+  }
+
+private:
+  const std::uint8_t * data_;
+  std::size_t size_;
+  std::size_t pos_ = 0;
+};
+
+enum class outcome
+{
+  ok,
+  length_error,
+  out_of_range,
+};
+
+template<
+  typename String
+>
+std::string_view
+view_of(const String & s) noexcept
+{
+  return std::string_view(s.data(), s.size());
+}
+
+/// Whether @a String can insert a range given by input iterators.
+template<
+  typename String,
+  typename = void
+>
+inline constexpr bool has_range_insert_v = false;
+
+template<
+  typename String
+>
+inline constexpr bool has_range_insert_v<String, std::void_t<decltype(std::declval<String &>().insert(
+  std::declval<String &>().cbegin(), std::istreambuf_iterator<char>(), std::istreambuf_iterator<char>()))>> = true;
+
+static_assert(has_range_insert_v<bounded_basic_string<char, 4>>);
+
+int
+sign(int value) noexcept
+{
+  return (value > 0) - (value < 0);
+}
+
+/// Applies one input to @a String with bound @a Bound and to a std::string model.
+template<
+  typename String,
+  std::size_t Bound
+>
+void
+run(const std::uint8_t * data, std::size_t size, const char * type_name)
+{
+  reader in(data, size);
+  String s;
+  std::string model;
+  std::uint8_t op = 0;
+
+  // Runs a modifying operation on both and checks the outcome
+  const auto modify = [&](auto && on_string, auto && on_model) {
+    std::string expected = model;
+    outcome want = outcome::ok;
+    try {
+      on_model(expected);
+      if (expected.size() > Bound) {
+        want = outcome::length_error;
+      }
+    } catch (const std::out_of_range &) {
+      want = outcome::out_of_range;
+    }
+    outcome got = outcome::ok;
+    try {
+      on_string(s);
+    } catch (const std::length_error &) {
+      got = outcome::length_error;
+    } catch (const std::out_of_range &) {
+      got = outcome::out_of_range;
+    }
+    if (want == outcome::out_of_range) {
+      // A bounded string may check the length before the position
+      FUZZ_REQUIRE(got != outcome::ok);
+    } else {
+      FUZZ_REQUIRE(got == want);
+    }
+    if (want == outcome::ok) {
+      model = std::move(expected);
+    }
+    FUZZ_REQUIRE(view_of(s) == model);
+    FUZZ_REQUIRE(s.size() <= Bound);
+  };
+
+  while (!in.done()) {
+    op = in.byte() % 26;
+    const std::string_view m(model);
+    switch (op) {
+      case 0: {
+        const std::size_t count = in.byte() % (Bound + 8);
+        const char ch = in.character();
+        modify([&](String & t) { t.assign(count, ch); }, [&](std::string & t) { t.assign(count, ch); });
+        break;
+      }
+      case 1: {
+        const std::string text = in.text();
+        const std::string_view sv(text);
+        modify([&](String & t) { t.assign(sv); }, [&](std::string & t) { t.assign(sv); });
+        break;
+      }
+      case 2: {
+        const std::string text = in.text(false);
+        modify([&](String & t) { t.assign(text.c_str()); }, [&](std::string & t) { t.assign(text.c_str()); });
+        break;
+      }
+      case 3: {
+        const std::string text = in.text();
+        const std::size_t count = in.byte() % (text.size() + 1);
+        modify([&](String & t) { t.assign(text.data(), count); },
+          [&](std::string & t) { t.assign(text.data(), count); });
+        break;
+      }
+      case 4: {
+        const std::string text = in.text();
+        const std::string_view sv(text);
+        modify([&](String & t) { t = sv; }, [&](std::string & t) { t = sv; });
+        break;
+      }
+      case 5: {
+        const std::size_t index = in.position(model.size());
+        const std::size_t count = in.byte() % (Bound + 8);
+        const char ch = in.character();
+        modify([&](String & t) { t.insert(index, count, ch); },
+          [&](std::string & t) { t.insert(index, count, ch); });
+        break;
+      }
+      case 6: {
+        const std::size_t index = in.position(model.size());
+        const std::string text = in.text();
+        const std::string_view sv(text);
+        modify([&](String & t) { t.insert(index, sv); }, [&](std::string & t) { t.insert(index, sv); });
+        break;
+      }
+      case 7: {
+        const std::size_t index = in.position(model.size());
+        const std::string text = in.text(false);
+        modify([&](String & t) { t.insert(index, text.c_str()); },
+          [&](std::string & t) { t.insert(index, text.c_str()); });
+        break;
+      }
+      case 8: {
+        const std::size_t index = in.position(model.size());
+        const std::string text = in.text();
+        const std::size_t count = in.byte() % (text.size() + 1);
+        modify([&](String & t) { t.insert(index, text.data(), count); },
+          [&](std::string & t) { t.insert(index, text.data(), count); });
+        break;
+      }
+      case 9: {
+        const char ch = in.character();
+        modify([&](String & t) { t.push_back(ch); }, [&](std::string & t) { t.push_back(ch); });
+        break;
+      }
+      case 10: {
+        const std::size_t index = in.position(model.size());
+        const std::size_t count = in.position(model.size());
+        modify([&](String & t) { t.erase(index, count); }, [&](std::string & t) { t.erase(index, count); });
+        break;
+      }
+      case 11:
+        if (!model.empty()) {
+          modify([](String & t) { t.pop_back(); }, [](std::string & t) { t.pop_back(); });
+        }
+        break;
+      case 12:
+        modify([](String & t) { t.clear(); }, [](std::string & t) { t.clear(); });
+        break;
+      case 13: {
+        const std::string needle = in.text();
+        const std::size_t pos = in.position(model.size());
+        FUZZ_REQUIRE(s.find(std::string_view(needle.data(), needle.size() % 4), pos) ==
+          m.find(std::string_view(needle.data(), needle.size() % 4), pos));
+        break;
+      }
+      case 14: {
+        const char ch = in.character();
+        const std::size_t pos = in.position(model.size());
+        FUZZ_REQUIRE(s.find(ch, pos) == m.find(ch, pos));
+        FUZZ_REQUIRE(s.rfind(ch, pos) == m.rfind(ch, pos));
+        break;
+      }
+      case 15: {
+        const std::string needle = in.text();
+        const std::string_view sv(needle.data(), needle.size() % 4);
+        const std::size_t pos = in.position(model.size());
+        FUZZ_REQUIRE(s.rfind(sv, pos) == m.rfind(sv, pos));
+        break;
+      }
+      case 16: {
+        const std::string set = in.text();
+        const std::string_view sv(set.data(), set.size() % 4);
+        const std::size_t pos = in.position(model.size());
+        FUZZ_REQUIRE(s.find_first_of(sv, pos) == m.find_first_of(sv, pos));
+        FUZZ_REQUIRE(s.find_first_not_of(sv, pos) == m.find_first_not_of(sv, pos));
+        break;
+      }
+      case 17: {
+        const std::string set = in.text();
+        const std::string_view sv(set.data(), set.size() % 4);
+        const std::size_t pos = in.position(model.size());
+        FUZZ_REQUIRE(s.find_last_of(sv, pos) == m.find_last_of(sv, pos));
+        FUZZ_REQUIRE(s.find_last_not_of(sv, pos) == m.find_last_not_of(sv, pos));
+        break;
+      }
+      case 18: {
+        // Compare against a prefix of the model with one character changed, or against other text
+        std::string other = in.byte() % 2 == 0 ? model.substr(0, in.position(model.size()) % (model.size() + 1))
+                                                : in.text();
+        if (!other.empty() && in.byte() % 2 == 0) {
+          other[in.byte() % other.size()] = in.character();
+        }
+        FUZZ_REQUIRE(sign(s.compare(std::string_view(other))) == sign(m.compare(other)));
+        break;
+      }
+      case 19: {
+        const std::size_t pos = in.position(model.size());
+        const std::size_t count = in.position(model.size());
+        if (pos > model.size()) {
+          bool threw = false;
+          try {
+            (void)s.substr(pos, count);
+          } catch (const std::out_of_range &) {
+            threw = true;
+          }
+          FUZZ_REQUIRE(threw);
+        } else {
+          FUZZ_REQUIRE(view_of(s.substr(pos, count)) == m.substr(pos, count));
+        }
+        break;
+      }
+      case 20: {
+        const std::size_t pos = in.position(model.size());
+        bool threw = false;
+        try {
+          FUZZ_REQUIRE(s.at(pos) == model.at(pos));
+        } catch (const std::out_of_range &) {
+          threw = true;
+        }
+        FUZZ_REQUIRE(threw == (pos >= model.size()));
+        break;
+      }
+      case 21: {
+        const String copy(s);
+        FUZZ_REQUIRE(view_of(copy) == model);
+        String assigned;
+        assigned = copy;
+        FUZZ_REQUIRE(view_of(assigned) == model);
+        break;
+      }
+      case 22: {
+        char buffer[Bound + 1];
+        const std::size_t count = in.byte() % (Bound + 2);
+        const std::size_t pos = in.position(model.size());
+        if (pos <= model.size()) {
+          const std::size_t copied = s.copy(buffer, count, pos);
+          FUZZ_REQUIRE(copied == m.substr(pos, count).size());
+          FUZZ_REQUIRE(std::string_view(buffer, copied) == m.substr(pos, count));
+        }
+        break;
+      }
+      case 23: {
+        // ltrim, rtrim or trim, of whitespace or of a set of characters
+        const std::uint8_t how = in.byte();
+        const bool whitespace = (how & 4U) == 0;
+        const std::string chars = whitespace ? std::string(" \t\n\v\f\r") : in.text();
+        const bool left = (how & 3U) != 1;
+        const bool right = (how & 3U) != 0;
+        std::string_view expected = m;
+        if (left) {
+          expected.remove_prefix(std::min(expected.find_first_not_of(chars), expected.size()));
+        }
+        if (right) {
+          const std::size_t last = expected.find_last_not_of(chars);
+          expected = expected.substr(0, last == std::string_view::npos ? 0 : last + 1);
+        }
+        if (left && right) {
+          FUZZ_REQUIRE((whitespace ? s.trimmed_view() : s.trimmed_view(chars)) == expected);
+        }
+        const std::string kept(expected);
+        modify([&](String & t) {
+          if (!right) {
+            whitespace ? t.ltrim() : t.ltrim(chars);
+          } else if (!left) {
+            whitespace ? t.rtrim() : t.rtrim(chars);
+          } else {
+            whitespace ? t.trim() : t.trim(chars);
+          }
+        }, [&](std::string & t) { t = kept; });
+        break;
+      }
+      case 24: {
+        // Insert from an istream, whose iterators can only be read once
+        const std::size_t index = in.byte() % (model.size() + 1);
+        const std::string text = in.text();
+        if constexpr (has_range_insert_v<String>) {
+          modify([&](String & t) {
+            std::istringstream stream(text);
+            t.insert(t.cbegin() + static_cast<std::ptrdiff_t>(index),
+              std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+          }, [&](std::string & t) { t.insert(index, text); });
+        }
+        break;
+      }
+      default:
+        FUZZ_REQUIRE(s.empty() == model.empty() && s.size() == model.size());
+        break;
+    }
+  }
+}
+
+}  // namespace
+
+extern "C" int
+LLVMFuzzerTestOneInput(const std::uint8_t * data, std::size_t size)
+{
+  run<bounded_basic_string<char, 1>, 1>(data, size, "bounded_basic_string<char, 1>");
+  run<bounded_basic_string<char, 15>, 15>(data, size, "bounded_basic_string<char, 15>");
+  run<bounded_basic_string<char, 16>, 16>(data, size, "bounded_basic_string<char, 16>");
+  run<bounded_basic_string<char, 64>, 64>(data, size, "bounded_basic_string<char, 64>");
+  run<inline_bounded_basic_string<char, 1>, 1>(data, size, "inline_bounded_basic_string<char, 1>");
+  run<inline_bounded_basic_string<char, 15>, 15>(data, size, "inline_bounded_basic_string<char, 15>");
+  run<inline_bounded_basic_string<char, 16>, 16>(data, size, "inline_bounded_basic_string<char, 16>");
+  run<inline_bounded_basic_string<char, 64>, 64>(data, size, "inline_bounded_basic_string<char, 64>");
+  return 0;
+}
+
+#if defined(BOUNDED_STRING_FUZZ_REPLAY)
+
+namespace {
+
+void
+replay_file(const std::filesystem::path & path)
+{
+  std::ifstream in(path, std::ios::binary);
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  (void)LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t *>(bytes.data()), bytes.size());
+}
+
+/// Replays inputs generated from fixed seeds, of every length up to 512 bytes.
+std::size_t
+replay_generated()
+{
+  constexpr std::size_t inputs = 2000;
+  std::vector<std::uint8_t> bytes;
+  for (std::size_t i = 0; i < inputs; ++i) {
+    // splitmix64, so that the inputs are the same everywhere
+    std::uint64_t state = 0x5EED + i;
+    const auto next = [&state] {
+      std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31U);
+    };
+    bytes.resize(i % 513);
+    for (std::uint8_t & b : bytes) {
+      b = static_cast<std::uint8_t>(next());
+    }
+    (void)LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+  }
+  return inputs;
+}
+
+}  // namespace
+
+int
+main(int argc, char ** argv)
+{
+  if (argc == 1) {
+    std::printf("replayed %zu generated inputs\n", replay_generated());
+    return 0;
+  }
+  std::size_t replayed = 0;
+  for (int i = 1; i < argc; ++i) {
+    const std::filesystem::path path(argv[i]);
+    if (std::filesystem::is_directory(path)) {
+      for (const auto & entry : std::filesystem::directory_iterator(path)) {
+        if (entry.is_regular_file()) {
+          replay_file(entry.path());
+          ++replayed;
+        }
+      }
+    } else {
+      replay_file(path);
+      ++replayed;
+    }
+  }
+  std::printf("replayed %zu inputs\n", replayed);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,154 @@
+// Throughput and latency of mpmc_bounded_string_queue for 1 to 32 threads.
+//
+// Usage: BoundedString_mpmc_bench [messages-per-run]
+//
+// Half of the threads produce and half consume (one of each for two threads;
+// a single thread alternates pushes and pops). Every message is 64 characters
+// and carries its send time, from which consumers sample end-to-end latency.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MpmcBoundedStringQueue.hpp"
+
+namespace {
+
+constexpr std::size_t message_size = 64;
+using queue_type = mpmc_bounded_string_queue<char, message_size>;
+using message_type = queue_type::value_type;
+using clock_type = std::chrono::steady_clock;
+
+enum class mode { try_op, spin, block };
+
+const char *
+mode_name(mode m)
+{
+  switch (m) {
+    case mode::try_op: return "try";
+    case mode::spin: return "spin";
+    case mode::block: return "block";
+  }
+  return "?";
+}
+
+std::int64_t
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    clock_type::now().time_since_epoch()).count();
+}
+
+void
+produce(queue_type & queue, mode m, std::size_t count)
+{
+  const auto fill = [](message_type & msg) {
+    const std::int64_t stamp = now_ns();
+    msg.assign(message_size, 'x');
+    std::memcpy(msg.data(), &stamp, sizeof(stamp));
+  };
+  for (std::size_t i = 0; i < count; ++i) {
+    switch (m) {
+      case mode::try_op:
+        while (!queue.try_emplace(fill)) {
+        }
+        break;
+      case mode::spin: queue.spin_emplace(fill); break;
+      case mode::block: queue.emplace(fill); break;
+    }
+  }
+}
+
+void
+consume(queue_type & queue, mode m, std::size_t count, std::vector<std::int64_t> & latencies)
+{
+  const auto read = [&latencies](const message_type & msg) {
+    if ((latencies.capacity() - latencies.size()) != 0) {
+      std::int64_t stamp = 0;
+      std::memcpy(&stamp, msg.data(), sizeof(stamp));
+      latencies.push_back(now_ns() - stamp);
+    }
+  };
+  for (std::size_t i = 0; i < count; ++i) {
+    switch (m) {
+      case mode::try_op:
+        while (!queue.try_consume(read)) {
+        }
+        break;
+      case mode::spin: queue.spin_consume(read); break;
+      case mode::block: queue.consume(read); break;
+    }
+  }
+}
+
+void
+run(mode m, unsigned threads, std::size_t messages)
+{
+  queue_type queue(1024);
+  const unsigned producers = std::max(1U, threads / 2);
+  const unsigned consumers = std::max(1U, threads - producers);
+  const std::size_t per_producer = messages / producers;
+  const std::size_t total = per_producer * producers;
+  constexpr std::size_t max_samples = 100000;
+
+  std::vector<std::vector<std::int64_t>> latencies(consumers);
+  std::vector<std::thread> workers;
+  const auto start = clock_type::now();
+  if (threads == 1) {
+    latencies[0].reserve(max_samples);
+    for (std::size_t i = 0; i < total; i += queue.capacity()) {
+      const std::size_t n = std::min<std::size_t>(queue.capacity(), total - i);
+      produce(queue, m, n);
+      consume(queue, m, n, latencies[0]);
+    }
+  } else {
+    for (unsigned p = 0; p < producers; ++p) {
+      workers.emplace_back(produce, std::ref(queue), m, per_producer);
+    }
+    for (unsigned c = 0; c < consumers; ++c) {
+      const std::size_t share = total / consumers + (c < total % consumers ? 1 : 0);
+      latencies[c].reserve(max_samples / consumers);
+      workers.emplace_back(consume, std::ref(queue), m, share, std::ref(latencies[c]));
+    }
+    for (auto & worker : workers) {
+      worker.join();
+    }
+  }
+  const std::chrono::duration<double> elapsed = clock_type::now() - start;
+
+  std::vector<std::int64_t> samples;
+  for (const auto & l : latencies) {
+    samples.insert(samples.end(), l.begin(), l.end());
+  }
+  std::sort(samples.begin(), samples.end());
+  const auto percentile = [&samples](double p) -> long long {
+    return samples.empty() ? 0 :
+      samples[static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1))];
+  };
+  std::printf("%-6s %7u %10u %10u %14.0f %10lld %10lld\n",
+    mode_name(m), threads, producers, consumers,
+    static_cast<double>(total) / elapsed.count(), percentile(0.5), percentile(0.99));
+}
+
+}  // namespace
+
+int
+main(int argc, char ** argv)
+{
+  const std::size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::printf("%-6s %7s %10s %10s %14s %10s %10s\n",
+    "mode", "threads", "producers", "consumers", "msgs/sec", "p50 ns", "p99 ns");
+  for (const mode m : {mode::try_op, mode::spin, mode::block}) {
+    for (const unsigned threads : {1U, 2U, 4U, 8U, 16U, 32U}) {
+      run(m, threads, messages);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+// Throughput and latency of spsc_bounded_string_ring with one producer and one consumer.
+//
+// Usage: BoundedString_spsc_bench [messages-per-run]
+//
+// Every message is 64 characters and carries its send time, from which the
+// consumer samples end-to-end latency. Messages are moved one at a time with
+// try_emplace/try_consume and in batches of 8 and 64 with
+// publish_batch/consume_batch; the target is 50M msgs/sec for batched traffic
+// when the two threads run on separate cores.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "SpscBoundedStringRing.hpp"
+
+namespace {
+
+constexpr std::size_t message_size = 64;
+using ring_type = spsc_bounded_string_ring<char, message_size>;
+using message_type = ring_type::value_type;
+using clock_type = std::chrono::steady_clock;
+
+std::int64_t
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    clock_type::now().time_since_epoch()).count();
+}
+
+void
+fill(message_type & msg)
+{
+  const std::int64_t stamp = now_ns();
+  msg.assign(message_size, 'x');
+  std::memcpy(msg.data(), &stamp, sizeof(stamp));
+}
+
+void
+produce(ring_type & ring, std::size_t batch, std::size_t count)
+{
+  std::size_t sent = 0;
+  while (sent < count) {
+    std::size_t n = 0;
+    if (batch == 1) {
+      n = ring.try_emplace(fill) ? 1 : 0;
+    } else {
+      n = ring.publish_batch(std::min(batch, count - sent),
+        [](message_type & msg, std::size_t) { fill(msg); });
+    }
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+    sent += n;
+  }
+}
+
+void
+consume(ring_type & ring, std::size_t batch, std::size_t count, std::vector<std::int64_t> & latencies)
+{
+  const auto read = [&latencies](const message_type & msg) {
+    if ((latencies.capacity() - latencies.size()) != 0) {
+      std::int64_t stamp = 0;
+      std::memcpy(&stamp, msg.data(), sizeof(stamp));
+      latencies.push_back(now_ns() - stamp);
+    }
+  };
+  std::size_t received = 0;
+  while (received < count) {
+    const std::size_t n = batch == 1 ?
+      (ring.try_consume(read) ? 1 : 0) :
+      ring.consume_batch(std::min(batch, count - received), read);
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+    received += n;
+  }
+}
+
+void
+run(std::size_t batch, std::size_t messages)
+{
+  ring_type ring(1024);
+  std::vector<std::int64_t> latencies;
+  latencies.reserve(100000);
+
+  const auto start = clock_type::now();
+  std::thread producer(produce, std::ref(ring), batch, messages);
+  consume(ring, batch, messages, latencies);
+  producer.join();
+  const std::chrono::duration<double> elapsed = clock_type::now() - start;
+
+  std::sort(latencies.begin(), latencies.end());
+  const auto percentile = [&latencies](double p) -> long long {
+    return latencies.empty() ? 0 :
+      latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))];
+  };
+  std::printf("%6zu %14.0f %10lld %10lld\n",
+    batch, static_cast<double>(messages) / elapsed.count(), percentile(0.5), percentile(0.99));
+}
+
+}  // namespace
+
+int
+main(int argc, char ** argv)
+{
+  const std::size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  std::printf("%6s %14s %10s %10s\n", "batch", "msgs/sec", "p50 ns", "p99 ns");
+  for (const std::size_t batch : {1U, 8U, 64U}) {
+    run(batch, messages);
+  }
+  return 0;
+}
@@ -1,7 +1,910 @@
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "AlignedBoundedString.hpp"
 #include "BoundedString.hpp"
+#include "BoundedStringBatch.hpp"
+#include "BoundedStringLog.hpp"
+#include "BoundedStringScratchPool.hpp"
+#include "BoundedStringSnapshotMap.hpp"
+#include "BoundedStringTranscode.hpp"
+#include "InlineBoundedString.hpp"
+#include "MpmcBoundedStringQueue.hpp"
+#include "SeqlockBoundedString.hpp"
+#include "SharedMemoryBoundedString.hpp"
+#include "SpscBoundedStringRing.hpp"
+#include "Utf8BoundedString.hpp"
+
+// Counts the diagnostics events of one type; the policy of every other type stays empty
+struct counting_diagnostics {
+  static inline int constructs = 0;
+  static inline int mutations = 0;
+  static inline std::size_t last_overflow = 0;
+
+  template<typename String>
+  static void on_construct(const String &) noexcept { ++constructs; }
+
+  template<typename String>
+  static void on_mutate(const String &) noexcept { ++mutations; }
+
+  template<typename String>
+  static void on_overflow(const String &, std::size_t attempted) noexcept { last_overflow = attempted; }
+};
+
+template<>
+struct bounded_string_diagnostics<bounded_basic_string<char, 6>> : counting_diagnostics {};
+
+namespace {
+
+void test_inline_bounded_string() {
+  using InlineString = inline_bounded_string<8>;
+  static_assert(std::is_trivially_copyable_v<InlineString>);
+  static_assert(std::is_standard_layout_v<InlineString>);
+
+  InlineString s("abc");
+  assert(s.size() == 3 && s == std::string_view("abc"));
+  s.append("de").insert(0, "x").push_back('!');
+  assert(s == std::string_view("xabcde!"));
+  s.erase(1, 3);
+  assert(s == std::string_view("xde!"));
+  assert(s.find('d') == 1 && s.rfind("e!") == 2);
+
+  bool threw = false;
+  try {
+    s.append("12345");
+  } catch (const std::length_error &) {
+    threw = true;
+  }
+  assert(threw && s == std::string_view("xde!"));
+}
+
+void test_seqlock_bounded_string() {
+  seqlock_bounded_string<32> shared;
+  assert(shared.load().empty());
+
+  // Every value the writer publishes is a run of one repeated character,
+  // so a torn read would show up as a mixed string.
+  constexpr int writes = 20000;
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&shared] {
+      while (shared.version() < writes) {
+        const auto value = shared.load();
+        for (const char ch : value) {
+          assert(ch == value.front());
+        }
+        std::this_thread::yield();
+      }
+    });
+  }
+  for (int i = 1; i <= writes; ++i) {
+    shared.store(inline_bounded_string<32>(static_cast<std::size_t>(i % 32),
+      static_cast<char>('a' + i % 26)));
+  }
+  for (auto & reader : readers) {
+    reader.join();
+  }
+  assert(shared.version() == writes);
+}
+
+void test_spsc_bounded_string_ring() {
+  spsc_bounded_string_ring<char, 16> ring(5);
+  assert(ring.capacity() == 8);
+  bool threw = false;
+  try {
+    spsc_bounded_string_ring<char, 16> huge(std::numeric_limits<std::size_t>::max());
+  } catch (const std::length_error &) {
+    threw = true;
+  }
+  assert(threw);
+
+  constexpr std::size_t messages = 100000;
+  std::thread producer([&ring] {
+    std::size_t sent = 0;
+    while (sent < messages) {
+      const std::size_t n = ring.publish_batch(messages - sent, [sent](auto & value, std::size_t i) {
+        value.assign(std::to_string(sent + i));
+      });
+      if (n == 0) {
+        std::this_thread::yield();
+      }
+      sent += n;
+    }
+  });
+  std::size_t received = 0;
+  while (received < messages) {
+    const std::size_t n = ring.consume_batch(4, [&received](const auto & value) {
+      assert(value == std::string_view(std::to_string(received)));
+      ++received;
+    });
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  inline_bounded_basic_string<char, 16> out;
+  const bool popped_empty = ring.try_pop(out);
+  const bool pushed = ring.try_push("hello");
+  const bool popped = ring.try_pop(out);
+  assert(!popped_empty && pushed && popped && out == std::string_view("hello"));
+}
+
+void test_mpmc_bounded_string_queue() {
+  mpmc_bounded_string_queue<char, 16> queue(4);
+  inline_bounded_basic_string<char, 16> out;
+  const bool popped_empty = queue.try_pop(out);
+  assert(!popped_empty);
+  for (int i = 0; i < 4; ++i) {
+    const bool pushed = queue.try_push(std::to_string(i));
+    assert(pushed);
+  }
+  const bool pushed_full = queue.try_push("full");
+  const bool popped = queue.try_pop(out);
+  assert(!pushed_full && popped && out == std::string_view("0"));
+  bool threw = false;
+  try {
+    mpmc_bounded_string_queue<char, 16> huge(std::numeric_limits<std::size_t>::max());
+  } catch (const std::length_error &) {
+    threw = true;
+  }
+  assert(threw);
+
+  // Blocking producers and consumers on a queue much smaller than the traffic
+  constexpr int per_producer = 5000;
+  std::vector<std::thread> threads;
+  std::atomic<long> sum{0};
+  for (int p = 0; p < 2; ++p) {
+    threads.emplace_back([&queue] {
+      for (int i = 1; i <= per_producer; ++i) {
+        queue.push(std::to_string(i));
+      }
+    });
+    threads.emplace_back([&queue, &sum] {
+      inline_bounded_basic_string<char, 16> value;
+      for (int i = 0; i < per_producer; ++i) {
+        queue.pop(value);
+        sum += std::stol(std::string(value.view()));
+      }
+    });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  // The three messages left over from above are drained last
+  for (int i = 1; i <= 3; ++i) {
+    queue.pop(out);
+    sum += std::stol(std::string(out.view()));
+  }
+  assert(sum == 2L * per_producer * (per_producer + 1) / 2 + 6);
+}
+
+void test_bounded_string_log() {
+  // Small enough that the producers wrap around the ring many times
+  bounded_string_log<char, 20> log(128);
+  assert(log.capacity() == 128);
+  const bool appended = log.try_append(inline_bounded_string<20>("first"));
+  assert(appended);
+
+  constexpr int per_producer = 3000;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < 3; ++p) {
+    producers.emplace_back([&log, p] {
+      for (int i = 0; i < per_producer; ++i) {
+        log.append(std::string(static_cast<std::size_t>(1 + i % 20), static_cast<char>('a' + p)));
+      }
+    });
+  }
+  std::vector<int> next(3, 0);
+  bool saw_first = false;
+  int consumed = 0;
+  while (consumed < 3 * per_producer + 1) {
+    const auto n = log.consume([&](std::string_view record) {
+      if (record == "first") {
+        saw_first = true;
+        return;
+      }
+      // Records from one producer arrive in the order it appended them
+      const int p = record.front() - 'a';
+      assert(record.size() == static_cast<std::size_t>(1 + next[p] % 20));
+      ++next[p];
+    });
+    consumed += static_cast<int>(n);
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+  }
+  for (auto & producer : producers) {
+    producer.join();
+  }
+  const auto leftover = log.consume([](std::string_view) {});
+  assert(saw_first && leftover == 0);
+
+  bool threw = false;
+  try {
+    log.append(std::string(21, 'x'));
+  } catch (const std::length_error &) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+void test_bounded_string_snapshot_map() {
+  using Map = bounded_string_snapshot_map<char, 8, 16>;
+  Map map(4);
+  auto reader = map.make_reader();
+  Map::mapped_type value;
+  const bool found_before_publish = reader.get("eur", value);
+  assert(!found_before_publish);
+
+  map.publish({{"usd", "nyse"}, {"eur", "xetra"}, {"usd", "nasdaq"}});
+  const bool found_usd = reader.get("usd", value);
+  assert(found_usd && value == std::string_view("nasdaq"));
+  {
+    // A pinned snapshot keeps seeing its table across publishes
+    const auto snap = reader.read();
+    map.publish({{"gbp", "lse"}});
+    assert(snap.size() == 2 && snap.find("eur") != nullptr && snap.find("gbp") == nullptr);
+    const auto pinned_reclaimed = map.collect();
+    assert(pinned_reclaimed == 1);
+  }
+  const auto unpinned_reclaimed = map.collect();
+  assert(unpinned_reclaimed == 0);
+  const bool found_eur = reader.get("eur", value);
+  const bool found_gbp = reader.get("gbp", value);
+  assert(!found_eur && found_gbp);
+
+  map.publish({{"k", "1"}});
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; ++r) {
+    readers.emplace_back([&map, &done] {
+      auto local = map.make_reader();
+      while (!done.load()) {
+        const auto snap = local.read();
+        // Every published table maps "k" to its own size
+        const auto * v = snap.find("k");
+        assert(v != nullptr && *v == std::string_view(std::to_string(snap.size())));
+      }
+    });
+  }
+  for (std::size_t n = 1; n < 200; ++n) {
+    std::vector<Map::value_type> entries;
+    entries.push_back({"k", Map::mapped_type(std::to_string(n + 1))});
+    for (std::size_t i = 0; i < n; ++i) {
+      entries.push_back({Map::key_type(std::to_string(i)), "x"});
+    }
+    map.publish(std::move(entries));
+    std::this_thread::yield();
+  }
+  done = true;
+  for (auto & thread : readers) {
+    thread.join();
+  }
+
+  bool threw = false;
+  try {
+    std::vector<Map::reader> all;
+    for (int i = 0; i < 4; ++i) {
+      all.push_back(map.make_reader());
+    }
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+void test_bounded_string_batch() {
+  bounded_string_thread_pool pool(4);
+  assert(pool.size() == 4);
+
+  std::vector<inline_bounded_string<32>> column;
+  for (int i = 0; i < 20000; ++i) {
+    column.emplace_back("  Symbol-" + std::to_string(i) + "\t");
+  }
+  bounded_string_batch::trim(column.data(), column.size(), pool);
+  bounded_string_batch::to_upper(column.data(), column.size(), pool);
+  assert(column[123] == std::string_view("SYMBOL-123"));
+  bounded_string_batch::to_lower(column.data(), column.size(), pool);
+  assert(column[19999] == std::string_view("symbol-19999"));
+
+  std::array<char, 256> table{};
+  for (std::size_t c = 0; c < table.size(); ++c) {
+    table[c] = c == '-' ? '_' : static_cast<char>(c);
+  }
+  bounded_string_batch::translate(column.data(), column.size(), table, pool);
+  assert(column[7] == std::string_view("symbol_7"));
+
+  std::vector<std::uint64_t> hashes(column.size());
+  bounded_string_batch::hash(column.data(), column.size(), hashes.data(), pool);
+  assert(hashes[5] == bounded_string_detail::hash_bytes("symbol_5", 8));
+  assert(hashes[5] != hashes[6]);
+
+  // Works on heap-backed bounded strings as well
+  const bounded_basic_string<char, 16> mixed[] = {"ok", "caf\xc3\xa9", "\xc3\x28", "\xed\xa0\x80"};
+  bool valid[4] = {};
+  bounded_string_batch::validate_utf8(mixed, 4, valid, pool);
+  assert(valid[0] && valid[1] && !valid[2] && !valid[3]);
+
+  bool threw = false;
+  try {
+    pool.parallel_for(1000, 10, [](std::size_t begin, std::size_t) {
+      if (begin == 500) {
+        throw std::runtime_error("chunk failed");
+      }
+    });
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  assert(threw);
+
+  // A parallel_for issued from a chunk runs inline instead of deadlocking
+  std::atomic<std::size_t> inner{0};
+  pool.parallel_for(8, 1, [&pool, &inner](std::size_t, std::size_t) {
+    pool.parallel_for(100, 10, [&inner](std::size_t begin, std::size_t end) { inner += end - begin; });
+  });
+  assert(inner == 800);
+
+  // So does one issued from a chunk of another pool which calls back into this one
+  bounded_string_thread_pool other(2);
+  inner = 0;
+  pool.parallel_for(4, 1, [&pool, &other, &inner](std::size_t, std::size_t) {
+    other.parallel_for(4, 1, [&pool, &inner](std::size_t, std::size_t) {
+      pool.parallel_for(10, 1, [&inner](std::size_t begin, std::size_t end) { inner += end - begin; });
+    });
+  });
+  assert(inner == 160);
+
+  // Heap-backed strings are chunked by their characters, not their object size
+  static_assert(bounded_string_batch::chunk_size<bounded_basic_string<char, 1024>>() <
+    bounded_string_batch::chunk_size<inline_bounded_string<16>>());
+
+  inline_bounded_basic_string<unsigned char, 8> bytes[] = {
+    inline_bounded_basic_string<unsigned char, 8>(3, static_cast<unsigned char>('a'))};
+  bounded_string_batch::to_upper(bytes, 1, pool);
+  bounded_string_batch::translate(bytes, 1, table, pool);
+  assert(bytes[0][0] == 'A' && bytes[0].size() == 3);
+}
+
+void test_bounded_string_scratch_pool() {
+  using Pool = bounded_string_scratch_pool<bounded_basic_string<char, 4096>>;
+  const char * first = nullptr;
+  {
+    auto outer = Pool::acquire();
+    outer->assign("scratch");
+    first = outer->data();
+    assert(outer->capacity() >= 4096);
+    {
+      auto inner = Pool::acquire();
+      assert(inner->empty() && inner->data() != first);
+    }
+  }
+  // LIFO: the buffer released last comes back first, cleared
+  auto again = Pool::acquire();
+  assert(again->empty());
+  auto stats = Pool::stats();
+  assert(stats.in_use == 1 && stats.high_water_mark == 2 && stats.pooled == 2);
+  assert(stats.acquisitions == 3);
+
+  // Each thread has its own pool and counters
+  std::thread([] {
+    assert(Pool::stats().pooled == 0);
+    Pool::reserve(3);
+    auto local = bounded_string_scratch_pool<inline_bounded_string<4096>>::acquire();
+    local->assign(4096, 'x');
+    assert(Pool::stats().pooled == 3);
+  }).join();
+  assert(Pool::stats().pooled == 2);
+}
+
+void test_aligned_bounded_string() {
+  static_assert(alignof(aligned_bounded_string<15>) == 64);
+  static_assert(sizeof(aligned_bounded_string<15>) == 64);
+  static_assert(sizeof(aligned_bounded_string<100, 128>) == 128);
+  static_assert(std::is_trivially_copyable_v<aligned_bounded_string<15>>);
+
+  aligned_bounded_string<15> s("thread-1");
+  s.append("-main");
+  assert(s == std::string_view("thread-1-main"));
+
+  per_thread_array<bounded_basic_string<char, 15>> names(4);
+  assert(reinterpret_cast<std::uintptr_t>(&names[1]) - reinterpret_cast<std::uintptr_t>(&names[0]) == 64);
+  names.local().assign("local");
+  std::size_t assigned = 0;
+  names.for_each([&assigned](const auto & name) { assigned += name.empty() ? 0 : 1; });
+  assert(assigned == 1);
+
+  // Short-lived threads reuse released elements and never share the long-lived one
+  per_thread_array<inline_bounded_string<15>> owners(2);
+  owners.local().assign("main");
+  for (int i = 0; i < 5; ++i) {
+    std::thread([&owners] {
+      auto & mine = owners.local();
+      assert(&mine == &owners[1] && &mine == &owners.local());
+      mine.assign("worker");
+    }).join();
+  }
+  assert(&owners.local() == &owners[0] && owners[0].view() == "main" && owners[1].view() == "worker");
+
+  // With every element held by a live thread, another thread gets none
+  std::atomic<bool> held{false};
+  std::atomic<bool> release{false};
+  std::thread holder([&owners, &held, &release] {
+    owners.local();
+    held = true;
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  while (!held) {
+    std::this_thread::yield();
+  }
+  bool threw = false;
+  std::thread([&owners, &threw] {
+    try {
+      owners.local();
+    } catch (const std::runtime_error &) {
+      threw = true;
+    }
+  }).join();
+  release = true;
+  holder.join();
+  assert(threw);
+
+  per_thread_array<inline_bounded_string<15>> none(0);
+  threw = false;
+  try {
+    none.local();
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+void test_shared_memory_bounded_string() {
+  static_assert(is_shared_memory_safe_v<inline_bounded_string<31>>);
+  static_assert(!is_shared_memory_safe_v<bounded_basic_string<char, 31>>);
+  static_assert(!is_shared_memory_safe_v<const char *>);
+  static_assert(!is_shared_memory_safe_v<int * [4]>);
+  static_assert(!is_shared_memory_safe_v<int inline_bounded_string<31>::*>);
+
+#if defined(__unix__)
+  using Ring = shm_bounded_string_ring<char, 31>;
+  using Map = shm_bounded_string_hash_map<char, 15, 31>;
+  constexpr std::size_t messages = 1000;
+  const std::size_t ring_bytes = (Ring::bytes_required(16) + 4095) & ~std::size_t{4095};
+  const std::size_t total = ring_bytes + Map::bytes_required(64);
+
+  const std::string name = "/bounded_string_test_" + std::to_string(getpid());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  assert(fd >= 0);
+  const int truncated = ftruncate(fd, static_cast<off_t>(total));
+  assert(truncated == 0);
+  void * region = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  assert(region != MAP_FAILED);
+  close(fd);
+  Ring * ring = Ring::create(region, 16);
+  Map * map = Map::create(static_cast<char *>(region) + ring_bytes, 64);
+  munmap(region, total);
+
+  const pid_t child = fork();
+  assert(child >= 0);
+  if (child == 0) {
+    // The producer opens the segment by name and maps it at its own address
+    const int child_fd = shm_open(name.c_str(), O_RDWR, 0);
+    void * mapped = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, child_fd, 0);
+    if (child_fd < 0 || mapped == MAP_FAILED) {
+      _exit(1);
+    }
+    Ring * producer = Ring::attach(mapped);
+    Map * table = Map::attach(static_cast<char *>(mapped) + ring_bytes);
+    table->insert_or_assign("producer", "child");
+    for (std::size_t i = 0; i < messages; ++i) {
+      const std::string message = "message " + std::to_string(i);
+      while (!producer->try_push(message)) {
+        std::this_thread::yield();
+      }
+    }
+    _exit(0);
+  }
+
+  fd = shm_open(name.c_str(), O_RDWR, 0);
+  region = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  assert(region != MAP_FAILED);
+  close(fd);
+  ring = Ring::attach(region);
+  map = Map::attach(static_cast<char *>(region) + ring_bytes);
+  Ring::value_type message;
+  for (std::size_t i = 0; i < messages; ++i) {
+    while (!ring->try_pop(message)) {
+      std::this_thread::yield();
+    }
+    assert(message == std::string_view("message " + std::to_string(i)));
+  }
+  int status = 0;
+  const pid_t reaped = waitpid(child, &status, 0);
+  assert(reaped == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  Map::mapped_type value;
+  const bool found_producer = map->find("producer", value);
+  assert(found_producer && value == std::string_view("child"));
+  const bool found_consumer = map->find("consumer", value);
+  assert(!found_consumer);
+
+  // A writer killed at an arbitrary point, possibly holding the bucket lock,
+  // must not block the survivors
+  const pid_t writer = fork();
+  assert(writer >= 0);
+  if (writer == 0) {
+    for (;;) {
+      map->insert_or_assign("producer", "killed");
+    }
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  kill(writer, SIGKILL);
+  const pid_t killed = waitpid(writer, &status, 0);
+  assert(killed == writer && WIFSIGNALED(status));
+  const bool reassigned = map->insert_or_assign("producer", "parent");
+  const bool found_reassigned = map->find("producer", value);
+  assert(reassigned && found_reassigned && value == std::string_view("parent"));
+
+  for (std::size_t i = 0; i < 63; ++i) {
+    const bool inserted = map->insert_or_assign("key" + std::to_string(i), std::to_string(i));
+    assert(inserted);
+  }
+  const bool overfilled = map->insert_or_assign("one-too-many", "x");
+  assert(map->size() == 64 && !overfilled);
+  const bool assigned = map->insert_or_assign("key7", "seven");
+  const bool found_key7 = map->find("key7", value);
+  assert(assigned && found_key7 && value == std::string_view("seven"));
+
+  munmap(region, total);
+  shm_unlink(name.c_str());
+#endif
+}
+
+void test_length_histogram() {
+#if defined(BOUNDED_STRING_HISTOGRAM)
+  // A bound no other test uses, so that only the lengths below are recorded
+  using String = bounded_basic_string<char, 100>;
+  using Histogram = bounded_string_length_histogram<String, 100>;
+
+  String s("abc");
+  s = "a";
+  s.assign(std::size_t{50}, 'x');
+  std::thread other([] {
+    for (int i = 0; i < 10; ++i) {
+      String t("hello");
+      assert(t.size() == 5);
+    }
+  });
+  other.join();
+
+  const bounded_string_length_snapshot snap = Histogram::snapshot();
+  assert(snap.upper_bound == 100 && snap.char_size == 1);
+  assert(snap.total == 13 && snap.max_length == 50);
+  assert(snap.buckets.size() == 8 && snap.buckets.back().lower == 64 && snap.buckets.back().upper == 100);
+  assert(snap.buckets[1].count == 1 && snap.buckets[2].count == 1);
+  assert(snap.buckets[3].count == 10 && snap.buckets[6].count == 1);
+  assert(snap.quantile(0.5) == 7 && snap.quantile(1.0) == 50);
+
+  bool listed = false;
+  for (const bounded_string_length_snapshot & h : bounded_string_length_histograms()) {
+    listed = listed || (h.upper_bound == 100 && h.total == 13);
+  }
+  assert(listed);
+#endif
+}
+
+void test_diagnostics_policy() {
+  using String = bounded_basic_string<char, 6>;
+  String a;
+  String b("abc");
+  assert(counting_diagnostics::constructs == 2 && counting_diagnostics::mutations == 0);
+  a = "xy";
+  b.push_back('d');
+  b.insert(0, "e");
+  assert(counting_diagnostics::mutations == 3 && b.size() == 5);
+  try {
+    b.insert(0, "12345");
+    assert(false);
+  } catch (const std::length_error &) {
+  }
+  assert(counting_diagnostics::last_overflow == 10 && counting_diagnostics::mutations == 3);
+}
+
+#if defined(BOUNDED_STRING_OVERFLOW_TELEMETRY)
+std::vector<bounded_string_overflow_event> sampled_overflows;
+
+void record_overflow(const bounded_string_overflow_event & event) {
+  sampled_overflows.push_back(event);
+}
+#endif
+
+void test_overflow_telemetry() {
+#if defined(BOUNDED_STRING_OVERFLOW_TELEMETRY)
+  using String = bounded_basic_string<char, 4>;
+  reset_bounded_string_overflow_sites();
+  (void)set_bounded_string_overflow_sample_period(2);
+  assert(set_bounded_string_overflow_hook(&record_overflow) == nullptr);
+
+  String s("abc");
+  const auto overflows = [&s](std::size_t count) {
+    try {
+      s.assign(count, 'x');
+    } catch (const std::length_error &) {
+      return true;
+    }
+    return false;
+  };
+  assert(overflows(5) && overflows(9) && overflows(7) && !overflows(4));
+  try {
+    s = "too long";
+    assert(false);
+  } catch (const std::length_error &) {
+  }
+
+  // The assign() site is the caller's, the operator's is in the library
+  const std::vector<bounded_string_overflow_site> sites = bounded_string_overflow_sites();
+  assert(sites.size() == 2);
+  assert(std::string_view(sites[0].file_name).find("test.cpp") != std::string_view::npos);
+  assert(sites[0].count == 3 && sites[0].max_attempted_length == 9 && sites[0].upper_bound == 4);
+  assert(std::string_view(sites[1].file_name).find("BoundedString.hpp") != std::string_view::npos);
+  assert(sites[1].count == 1 && sites[1].max_attempted_length == 8);
+
+  // Every second overflow of a site is sampled, starting with the first
+  assert(sampled_overflows.size() == 3);
+  assert(sampled_overflows[0].attempted_length == 5 && sampled_overflows[1].attempted_length == 7);
+  assert(sampled_overflows[0].location.line() == sites[0].line);
+  assert(sampled_overflows[2].attempted_length == 8 && sampled_overflows[2].upper_bound == 4);
+
+  assert(set_bounded_string_overflow_hook(nullptr) == &record_overflow);
+  (void)set_bounded_string_overflow_sample_period(1);
+  reset_bounded_string_overflow_sites();
+#endif
+}
+
+void test_utf8_bounded_string() {
+  // "hé€" is 1 + 2 + 3 bytes
+  const std::string_view mixed = "h\xC3\xA9\xE2\x82\xAC";
+
+  utf8_bounded_string<6> column(mixed);
+  assert(column.size() == 6 && column.size_codepoints() == 3);
+  bool threw = false;
+  try { column.append("x"); } catch (const std::length_error &) { threw = true; }
+  assert(threw && column == mixed);
+  threw = false;
+  try { column.assign("\xC3"); } catch (const std::invalid_argument &) { threw = true; }
+  assert(threw && column == mixed);
+  threw = false;
+  try { column.push_back(0xD800); } catch (const std::invalid_argument &) { threw = true; }
+  assert(threw);
+
+  // Truncation backs off to the start of the euro sign rather than splitting it
+  utf8_bounded_string<5, utf8_bound::bytes, utf8_overflow::truncate> truncated(mixed);
+  assert(truncated == "h\xC3\xA9");
+  truncated.push_back(U'€');
+  assert(truncated == "h\xC3\xA9");
+  truncated.push_back(U'x');
+  truncated.push_back(U'y');
+  assert(truncated == "h\xC3\xA9xy");
+  truncated.pop_back();
+  truncated.pop_back();
+  truncated.pop_back();
+  assert(truncated == "h");
+
+  utf8_bounded_string<3, utf8_bound::code_points> chars(mixed);
+  assert(chars.max_bytes() == 12 && chars.size_codepoints() == 3);
+  threw = false;
+  try { chars.push_back(U'\U0001F600'); } catch (const std::length_error &) { threw = true; }
+  assert(threw);
+
+  // Long enough for the vector paths of the kernels
+  std::string text;
+  for (int i = 0; i < 20; ++i) {
+    text += "a\xF0\x9F\x98\x80";
+  }
+  utf8_bounded_string<25, utf8_bound::code_points, utf8_overflow::truncate> emoji(text);
+  assert(emoji.size_codepoints() == 25 && emoji.size() == 12 * 5 + 1);
+  emoji.clear();
+  emoji.append("\xE2\x82\xAC");
+  emoji.append(text);
+  assert(emoji.size_codepoints() == 25 && emoji.size() == 3 + 12 * 5);
+
+  assert(utf8_truncate(text, 9) == text.substr(0, 6));
+  assert(utf8_truncate(text, 4) == "a");
+  assert(utf8_truncate_code_points(text, 39) == text.substr(0, 19 * 5 + 1));
+  assert(utf8_truncate_code_points(text, 100) == text);
+  static_assert(std::is_trivially_copyable_v<utf8_bounded_string<8>>);
+}
+
+void test_transcode() {
+  static_assert(transcoded_bound_v<char, char16_t, 10> == 10);
+  static_assert(transcoded_bound_v<char16_t, char, 10> == 30);
+  static_assert(transcoded_bound_v<char32_t, char, 10> == 40);
+  static_assert(transcoded_bound_v<char32_t, char16_t, 10> == 20);
+
+  // Long enough for the vector paths, with every sequence length mixed in
+  std::string utf8;
+  for (int i = 0; i < 8; ++i) {
+    utf8 += "ASCII run of some length, h\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80.";
+  }
+  bounded_basic_string<char, 512> source(utf8.data(), utf8.size());
+  transcoded_bounded_string<char16_t, char, 512> utf16;
+  transcode_result result = transcode_utf(source, utf16);
+  assert(result && result.read == utf8.size() && utf16.size() == result.written);
+  assert(utf16.size() == 8 * 34);
+  transcoded_bounded_string<char32_t, char16_t, transcoded_bound_v<char, char16_t, 512>> utf32;
+  assert(transcode_utf(utf16, utf32) && utf32.size() == 8 * 33);
+  assert(utf32[27] == U'é' && utf32[31] == U'\U0001F600');
+  transcoded_bounded_string<char16_t, char32_t, 512> utf16_again;
+  assert(transcode_utf(utf32, utf16_again) && utf16_again.size() == utf16.size());
+  transcoded_bounded_string<char, char32_t, 512> utf8_again;
+  assert(transcode_utf(utf32, utf8_again) && std::string_view(utf8_again.data(), utf8_again.size()) == utf8);
+  transcoded_bounded_string<char, char16_t, 512> utf8_from_utf16;
+  assert(transcode_utf(utf16, utf8_from_utf16) && utf8_from_utf16.size() == utf8.size());
+  transcoded_bounded_string<char32_t, char, 512> utf32_direct;
+  assert(transcode_utf(source, utf32_direct) && utf32_direct.size() == utf32.size());
+
+  // Errors are reported with the offset of the ill-formed sequence and the prefix converted
+  const inline_bounded_basic_string<char16_t, 4> unpaired(u"ab\xD800" "c");
+  inline_bounded_basic_string<char, 12> narrow;
+  result = transcode_utf(unpaired, narrow);
+  assert(result.status == transcode_status::invalid_input && result.read == 2);
+  assert(narrow.view() == "ab");
+  const inline_bounded_basic_string<char32_t, 2> too_large(U"a\x110000");
+  inline_bounded_basic_string<char16_t, 4> wide;
+  assert(!transcode_utf(too_large, wide) && wide.size() == 1);
+  const char overlong[] = "xy\xC0\xAF";
+  char16_t units[4];
+  result = transcode_utf(overlong, 4, units);
+  assert(!result && result.read == 2 && result.written == 2);
+}
+
+void test_ascii_case() {
+  // Every length up to 161 bytes reaches each vector width and the scalar tail
+  std::string mixed;
+  for (int i = 0; i < 7; ++i) {
+    mixed += "Header-Name: \xC3\x89t\xC3\xA9 @[`{";
+  }
+  std::string lower = mixed;
+  std::string upper = mixed;
+  for (char & ch : lower) {
+    ch = ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch + ('a' - 'A')) : ch;
+  }
+  for (char & ch : upper) {
+    ch = ch >= 'a' && ch <= 'z' ? static_cast<char>(ch - ('a' - 'A')) : ch;
+  }
+  for (std::size_t length = 0; length <= mixed.size(); ++length) {
+    const std::string_view input(mixed.data(), length);
+    inline_bounded_basic_string<char, 192> s(input);
+    s.to_upper();
+    assert(s.view() == std::string_view(upper.data(), length));
+    s.casefold_ascii();
+    assert(s.view() == std::string_view(lower.data(), length));
+  }
+
+  const bounded_basic_string<char, 192> original(mixed.data(), mixed.size());
+  const bounded_basic_string<char, 192> folded = casefold_ascii(original);
+  assert(std::string_view(folded.data(), folded.size()) == lower);
+  assert(std::string_view(original.data(), original.size()) == mixed);
+  bounded_basic_string<char, 192> shouted = to_upper(original);
+  assert(std::string_view(shouted.data(), shouted.size()) == upper);
+  shouted.to_lower();
+  assert(std::string_view(shouted.data(), shouted.size()) == lower);
+  static_assert(noexcept(shouted.to_upper()));
+
+  const inline_bounded_string<8> name("X-Id");
+  assert(to_lower(name).view() == "x-id" && to_upper(name).view() == "X-ID" && name.view() == "X-Id");
+}
+
+/// Trims @a s the slow way, as the reference for the vector scans.
+std::string_view reference_trim(std::string_view s, std::string_view chars, bool left, bool right) {
+  if (left) {
+    s.remove_prefix(std::min(s.find_first_not_of(chars), s.size()));
+  }
+  if (right) {
+    const std::size_t last = s.find_last_not_of(chars);
+    s.remove_suffix(last == std::string_view::npos ? s.size() : s.size() - last - 1);
+  }
+  return s;
+}
+
+void test_trim() {
+  const std::string_view spaces(" \t\n\v\f\r", 6);
+  const std::string_view custom = "-=*";
+  // Padding lengths either side of 16 and 32 reach the vector and scalar paths
+  for (const std::size_t pad : {0, 1, 15, 16, 17, 40}) {
+    for (const std::size_t body : {0, 1, 5, 20}) {
+      std::string text;
+      for (std::size_t i = 0; i < pad; ++i) {
+        text += spaces[i % spaces.size()];
+      }
+      for (std::size_t i = 0; i < body; ++i) {
+        text += i % 3 == 1 ? ' ' : static_cast<char>('a' + i % 26);
+      }
+      text += std::string(pad / 2, '\t');
+      std::string marked = text;
+      for (char & ch : marked) {
+        ch = ch == ' ' ? '-' : ch == '\t' ? '*' : ch == '\n' ? '=' : ch;
+      }
+
+      inline_bounded_string<128> s(text);
+      assert(s.trimmed_view() == reference_trim(text, spaces, true, true));
+      s.rtrim();
+      assert(s.view() == reference_trim(text, spaces, false, true));
+      s = std::string_view(text);
+      s.ltrim();
+      assert(s.view() == reference_trim(text, spaces, true, false));
+      s = std::string_view(marked);
+      assert(s.trimmed_view(custom) == reference_trim(marked, custom, true, true));
+      s.trim(custom);
+      assert(s.view() == reference_trim(marked, custom, true, true));
+
+      bounded_basic_string<char, 128> b(text.c_str(), text.size());
+      const std::string_view expected = reference_trim(text, spaces, true, true);
+      assert(b.trimmed_view() == expected);
+      b.trim();
+      assert(std::string_view(b.data(), b.size()) == expected);
+      b.assign(marked.c_str(), marked.size());
+      b.ltrim(custom);
+      assert(std::string_view(b.data(), b.size()) == reference_trim(marked, custom, true, false));
+      b.rtrim(custom);
+      assert(std::string_view(b.data(), b.size()) == reference_trim(marked, custom, true, true));
+    }
+  }
+
+  inline_bounded_basic_string<char16_t, 16> wide(u"\t wide  ");
+  wide.trim();
+  assert(wide.view() == u"wide");
+  assert(wide.trimmed_view(u"we") == u"id");
+
+  // erase(0, 0) moves nothing and erase(0, k) keeps the rest
+  inline_bounded_string<16> token("key=value");
+  token.erase(0, 0);
+  token.erase(0, 4);
+  assert(token.view() == "value");
+}
+
+}  // namespace
 
 int main() {
   using BoundedString = bounded_basic_string<char, 10>;
   BoundedString b;
+
+  test_inline_bounded_string();
+  test_seqlock_bounded_string();
+  test_spsc_bounded_string_ring();
+  test_mpmc_bounded_string_queue();
+  test_bounded_string_log();
+  test_bounded_string_snapshot_map();
+  test_bounded_string_batch();
+  test_bounded_string_scratch_pool();
+  test_aligned_bounded_string();
+  test_shared_memory_bounded_string();
+  test_diagnostics_policy();
+  test_length_histogram();
+  test_overflow_telemetry();
+  test_utf8_bounded_string();
+  test_transcode();
+  test_ascii_case();
+  test_trim();
   return 0;
 }